@@ -8,6 +8,7 @@
 #include <vector>
 
 #include <video.hpp>
+#include <renderer/preview.hpp>
 #include <SDL3/SDL_opengl.h>
 #include <widgets.hpp>
 
@@ -90,6 +91,10 @@ protected:
 
     std::shared_ptr<Frame> frame;
 
+    PreviewScaler previewScaler;
+    // how much the player scaled the frame down last time it was drawn
+    float displayScale = 1.f;
+
     ImGuiWindowClass bareWindowClass;
 
     void setupStyle();
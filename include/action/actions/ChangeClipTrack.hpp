@@ -1,23 +1,21 @@
 #pragma once
 
 #include "../action.hpp"
-#include <string>
+#include <vector>
 #include <clips/clip.hpp>
 
 enum class TrackType;
 
 class ChangeClipTrack : public Action {
 protected:
-    std::vector<std::string> uIDs;
+    std::vector<std::shared_ptr<Clip>> clips;
     int deltaTrack;
     bool isOnSameTracks;
     TrackType selectedType;
 
-    std::vector<std::shared_ptr<Clip>> getClips();
-
     void moveByTrack(int delta);
 public:
-    ChangeClipTrack(std::vector<std::string> uIDs, int deltaTrack, TrackType selectedType, bool isOnSameTracks);
+    ChangeClipTrack(std::vector<std::shared_ptr<Clip>> clips, int deltaTrack, TrackType selectedType, bool isOnSameTracks);
 
     void perform() override;
     void undo() override;
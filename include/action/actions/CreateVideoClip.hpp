@@ -10,8 +10,8 @@ protected:
     int frame;
     int trackIdx;
 
-    std::string videoUID;
-    std::string audioUID;
+    std::shared_ptr<Clip> videoClip;
+    std::shared_ptr<AudioClip> audioClip;
 public:
     CreateVideoClip(ExtClipMetadata metadata, int frame, int trackIdx): metadata(metadata), frame(frame), trackIdx(trackIdx) {}
 
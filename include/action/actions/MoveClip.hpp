@@ -1,17 +1,15 @@
 #pragma once
 
 #include "../action.hpp"
-#include <string>
+#include <vector>
 #include <clips/clip.hpp>
 
 class MoveClip : public Action {
 protected:
-    std::vector<std::string> uIDs;
+    std::vector<std::shared_ptr<Clip>> clips;
     int deltaFrame;
-
-    std::vector<std::shared_ptr<Clip>> getClips();
 public:
-    MoveClip(std::vector<std::string> uIDs, int deltaFrame);
+    MoveClip(std::vector<std::shared_ptr<Clip>> clips, int deltaFrame);
 
     void perform() override;
     void undo() override;
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// a decoded yuv420p frame, Y then U then V packed one after the other
+struct DecodedFrame {
+    std::vector<uint8_t> data;
+    int width = 0, height = 0;
+
+    std::array<const uint8_t*, 3> planes() const {
+        const uint8_t* u = data.data() + width * height;
+        return { data.data(), u, u + (width / 2) * (height / 2) };
+    }
+};
+
+// process wide cache of decoded source frames, keyed by (media path, source frame)
+// every VideoClip using the same file shares entries, so scrubbing back over
+// frames that were already decoded skips mlt entirely
+class FrameCache {
+public:
+    using Entry = std::shared_ptr<const DecodedFrame>;
+
+    static constexpr size_t DEFAULT_BUDGET = 512ull * 1024 * 1024;
+protected:
+    struct Key {
+        std::string path;
+        int frame;
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<std::string>()(key.path) ^ (std::hash<int>()(key.frame) * 0x9e3779b97f4a7c15ull);
+        }
+    };
+
+    // most recently used at the front
+    std::list<std::pair<Key, Entry>> entries;
+    std::unordered_map<Key, decltype(entries)::iterator, KeyHash> lookup;
+
+    mutable std::mutex mutex;
+    size_t budget = DEFAULT_BUDGET;
+    size_t usage = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+
+    FrameCache() = default;
+    // expects the mutex to be held
+    void evict();
+public:
+    static FrameCache& get();
+
+    // nullptr on a miss
+    Entry find(const std::string& path, int frame);
+    void insert(const std::string& path, int frame, Entry decoded);
+
+    void setBudget(size_t bytes);
+    void clear();
+
+    size_t getBudget() const;
+    size_t getUsage() const;
+    size_t getHits() const;
+    size_t getMisses() const;
+    size_t getCount() const;
+};
@@ -1,11 +1,12 @@
 #pragma once
 
-#include <map>
 #include <unordered_map>
 #include <easings.hpp>
+#include <clips/keyframes.hpp>
 
 #include <common.hpp>
 #include <frame.hpp>
+#include <slotmap.hpp>
 #include <utils.hpp>
 
 #include <Geode/Result.hpp>
@@ -25,7 +26,7 @@ struct PropertyKeyframeMeta {
     animation::Easing easing;
     animation::EasingMode mode;
 
-    void write(qn::HeapByteWriter& writer) {
+    void write(qn::HeapByteWriter& writer) const {
         writer.writeI16((int)easing);
         writer.writeI16((int)mode);
     }
@@ -38,34 +39,78 @@ struct PropertyKeyframeMeta {
 
 class Clip;
 
+// which keyframes a property sits between, and how far along (eased), on each frame
+// of a range. what processKeyframe would work out for those frames, see evaluateRange
+struct KeyframeSamples {
+    // absolute frame of the first sample
+    int startFrame = 0;
+    int count = 0;
+    std::vector<int> previous;
+    std::vector<int> next;
+    std::vector<float> progress;
+    // evaluateRange's working space, kept around so refills don't allocate
+    std::vector<double> scratch;
+
+    bool covers(int frame) const { return frame >= startFrame && frame < startFrame + count; }
+};
+
 // this is weird however it allows me
 // to use template arguments in ClipProperty
 // :double_thumbs:
 class ClipPropertyBase : public std::enable_shared_from_this<ClipPropertyBase> {
+protected:
+    // keyframeInfo lined up with the keyframes, the easing into each one
+    // rebuilt by processKeyframe whenever either of them changed
+    std::vector<animation::EasingFunction> easings;
+    uint32_t compiledVersion = UINT32_MAX;
+    uint32_t compiledInfoVersion = UINT32_MAX;
+    // the keyframe the last evaluation was at or after, playback mostly stays
+    // there or moves one on, seeks binary search
+    size_t cursor = 0;
+
+    void compileKeyframes();
+    size_t findSegment(const std::vector<int>& frames, int frame);
 public:
+    // set while exporting, processKeyframe uses these for the frames they cover
+    const KeyframeSamples* samples = nullptr;
+
     ClipPropertyBase() {}
 
     Clip* clip;
     std::string id = "";
     std::string name = "";
     PropertyType type;
-    std::map<int, PropertyKeyframeMeta> keyframeInfo;
+    KeyframeMap<PropertyKeyframeMeta> keyframeInfo;
 
     virtual void drawProperty() {}
     void _drawProperty();
 
+    // `previous` and `next` are indices into the keyframes, not frames
     virtual void updateData(float progress, int previous, int next) {}
-    virtual std::vector<int> getKeyframes() { fmt::println("calling the virtual"); return {}; }
+    virtual const std::vector<int>& getKeyframes() const { static const std::vector<int> none; return none; }
+    virtual uint32_t getKeyframeVersion() const { return 0; }
+    virtual size_t getKeyframeCount() { return 0; }
     virtual void writeData(qn::HeapByteWriter& writer) {}
     virtual void readData(qn::ByteReader& reader) {}
 
     virtual void addKeyframe(int frame) {}
     virtual void removeKeyframe(int frame) {}
 
+    // mixes the current (evaluated) value into `seed`
+    virtual void hashData(size_t& seed) {}
+
     void processKeyframe(int frame);
 
+    // compiles the keyframe lookups if they're out of date
+    // call from the thread that owns the property before handing it to evaluateRange,
+    // which leaves `out` empty otherwise
+    void prepareEvaluation();
+    // fills `out` for `count` frames from `startFrame` (absolute, like processKeyframe's)
+    // only reads the property, so any thread can run it while nothing edits it
+    void evaluateRange(int startFrame, int count, KeyframeSamples& out) const;
+
     void write(qn::HeapByteWriter& writer) {
-        writer.writeI16(debug((int)type));
+        writer.writeI16((int)type);
         UNWRAP_WITH_ERR(writer.writeStringU32(id));
         UNWRAP_WITH_ERR(writer.writeStringU32(name));
 
@@ -127,6 +172,9 @@ enum class ClipType {
     None
 };
 
+// what the editor refers to clips by, uIDs are for linking
+using ClipHandle = SlotHandle;
+
 class Clip {
 protected:
     Clip(int startFrame, int duration): Clip(startFrame, duration, utils::generateUUID()) {}
@@ -150,6 +198,9 @@ public:
     std::string uID; // unique ID
     std::vector<std::string> linkedClips; // linked clip IDs
 
+    // where the clip lives in its Video's slot map, invalid while it isn't in one
+    ClipHandle handle;
+
     template<typename T>
     geode::Result<std::shared_ptr<T>, std::string> getProperty(const std::string& id) {
         if (!m_properties.contains(id)) {
@@ -168,6 +219,36 @@ public:
 
     virtual void render(Frame* frame) {}
     virtual void onDelete() {}
+    // the clip left the screen (or its track), let go of anything only needed while it's drawn
+    virtual void onInactive() {}
+
+    // mixes in anything besides the properties and opacity that changes what render() draws
+    // (the source frame of a video, say). called after keyframes are processed
+    virtual void hashContent(size_t& seed) {}
+
+    // false for clips whose pixels change over time on their own (video)
+    virtual bool hasStaticContent() { return true; }
+    // no property has more than one keyframe, so every frame draws the same thing (fades aside)
+    bool isTimeInvariant();
+    // every property's keyframe version added up, it moves whenever any of them is edited
+    uint64_t getKeyframeVersions();
+
+    // for time invariant clips, getKeyframeVersions() when the properties were last processed
+    // and the hash of them back then. VideoTrack::prepare skips both while it hasn't moved
+    uint64_t evaluatedVersion = UINT64_MAX;
+    size_t evaluatedHash = 0;
+
+    // what a time invariant clip drew at full opacity, premultiplied, only as big as what it
+    // covers. blitted with the fade applied instead of drawing the clip again, see VideoTrack::drawClip
+    std::shared_ptr<Frame> staticCache;
+    size_t staticHash = 0;
+    // it drew nothing on screen last time, so there's no cache and nothing to blit
+    bool staticEmpty = false;
+
+    void releaseStaticCache() {
+        staticCache = nullptr;
+        staticEmpty = false;
+    }
 
     virtual void write(qn::HeapByteWriter& writer);
 
@@ -191,7 +272,7 @@ class ClipProperty : public ClipPropertyBase {
 public:
     ClipProperty() {}
     T data;
-    std::map<int, T> keyframes;
+    KeyframeMap<T> keyframes;
 
     void addKeyframe(int frame) override {
         keyframes[frame] = data;
@@ -201,14 +282,20 @@ public:
         keyframes.erase(frame);
     }
 
-    std::vector<int> getKeyframes() override {
-        std::vector<int> res;
+    void hashData(size_t& seed) override {
+        utils::hashCombine(seed, utils::hashValue(data));
+    }
 
-        for (auto [key, _] : keyframes) {
-            res.push_back(key);
-        }
+    size_t getKeyframeCount() override {
+        return keyframes.size();
+    }
+
+    const std::vector<int>& getKeyframes() const override {
+        return keyframes.getFrames();
+    }
 
-        return res;
+    uint32_t getKeyframeVersion() const override {
+        return keyframes.getVersion();
     }
 
     void setData(T data, int keyframe) {
@@ -11,9 +11,6 @@ namespace clips {
     class ImageClip : public Clip {
     private:
         GLuint texture;
-        GLuint VAO;
-        GLuint VBO;
-        GLuint EBO;
         unsigned char* imageData;
 
         int width, height;
@@ -21,6 +18,9 @@ namespace clips {
 
         std::shared_ptr<Frame> previewFrame;
 
+        // bigger images are shrunk on import, most drivers won't take a texture past this anyway
+        static constexpr int MAX_TEXTURE_SIZE = 8192;
+
         bool initialize();
     public:
         bool initialized = false;
@@ -4,15 +4,27 @@
 #include <common.hpp>
 #include <frame.hpp>
 
+struct TextLayout;
+
 namespace clips {
     class Text : public Clip {
     protected:
         std::shared_ptr<Frame> previewFrame;
+
+        // rebuilt only when the text, font or size change
+        std::shared_ptr<TextLayout> layout;
+        std::string layoutText;
+        std::string layoutFont;
+        float layoutSize = 0.f;
+        std::string fontPath;
+
+        void updateLayout();
     public:
         Vector2DF size;
 
         Text();
         void render(Frame* frame) override;
+        void hashContent(size_t& seed) override;
 
         ClipType getType() override { return ClipType::Text; }
         Vector2D getSize() override;
@@ -11,12 +11,35 @@
 
 #include <frame.hpp>
 #include <utils.hpp>
+#include <proxy/reader.hpp>
+#include <cache/frame.hpp>
 
 namespace clips {
     class VideoClip : public Clip {
     protected:
+        struct PreviewImage {
+            FrameCache::Entry image;
+            // size it's drawn at, a proxy is smaller than the source
+            int drawWidth = 0, drawHeight = 0;
+        };
+
         bool decodeFrame(int frameNumber);
-        std::array<uint8_t*, 3> decodeFrameRaw(int frameNumber);
+        // goes through the shared FrameCache before seeking mlt
+        FrameCache::Entry decodeSource(int frameNumber);
+        PreviewImage decodePreview(int frameNumber);
+
+        // the read-ahead ring's copy of `frameNumber`, nullptr if it isn't there (yet)
+        FrameCache::Entry takeReadAhead(int frameNumber);
+        // tells the read-ahead thread where the playhead is, flushing the ring on a seek
+        // the thread is started here the first time, so clips that never play don't hold one
+        void requestReadAhead(int frameNumber);
+        // stops the read-ahead thread and drops what it decoded, the next request starts it again
+        void joinReadAhead();
+        void readAheadLoop();
+        void uploadYUV(const std::array<const uint8_t*, 3>& planes, int w, int h);
+
+        // the proxy for this clip if one has been written, nullptr otherwise
+        std::shared_ptr<ProxyReader> getProxy();
 
         bool initialize();
 
@@ -26,12 +49,11 @@ namespace clips {
         int width = 0, height = 0, fps = 0;
         std::string path;
         bool initialized = false;
-        bool hasUploaded = false;
+        int uploadedWidth = 0, uploadedHeight = 0;
+        // whatever is in the textures right now
+        std::shared_ptr<const void> uploadedData;
 
         GLuint textureY, textureU, textureV;
-        GLuint VAO;
-        GLuint VBO;
-        GLuint EBO;
 
         std::thread previewGenThread;
         std::mutex framesMutex;
@@ -40,8 +62,29 @@ namespace clips {
         std::atomic<bool> stopGen = false;
         
         std::vector<int> pendingFrames;
-        std::unordered_map<int, std::array<uint8_t*, 3>> finishedFrames;
+        std::unordered_map<int, PreviewImage> finishedFrames;
         std::unordered_map<int, std::shared_ptr<Frame>> previewFrames;
+        // thumbnails are laid out at the project resolution but rendered at this scale
+        static constexpr float PREVIEW_SCALE = 0.25f;
+
+        // frames decoded ahead of the playhead during playback / export
+        // slot = frame % READ_AHEAD_FRAMES, so looking one up is O(1)
+        static constexpr int READ_AHEAD_FRAMES = 8;
+        std::thread readAheadThread;
+        std::mutex readAheadMutex;
+        std::condition_variable readAheadCv;
+        std::array<std::pair<int, FrameCache::Entry>, READ_AHEAD_FRAMES> readAhead;
+        // playhead the thread decodes ahead of, -1 while there's nothing to do
+        int readAheadFrom = -1;
+        int readAheadDirection = 1;
+        // bumped on every flush, decodes that started before it are thrown away
+        int readAheadEpoch = 0;
+        int lastRequestedFrame = -1;
+        bool stopReadAhead = false;
+
+        std::mutex proxyMutex;
+        std::shared_ptr<ProxyReader> proxy;
+        int proxyGeneration = -1;
     public:
         VideoClip(const std::string& path);
         VideoClip();
@@ -50,6 +93,9 @@ namespace clips {
         ClipType getType() override { return ClipType::Video; }
 
         void render(Frame* frame) override;
+        void hashContent(size_t& seed) override;
+        bool hasStaticContent() override { return false; }
+        void onInactive() override;
         
         void write(qn::HeapByteWriter& writer) override {
             Clip::write(writer);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// keyframes of a property as two flat arrays sorted by frame, so evaluating one is a
+// couple of array reads instead of walking a std::map. indexed like a map for editing
+// (`keyframes[frame] = value` inserts or overwrites), anything that can change the
+// keys or values bumps the version so ClipPropertyBase knows to recompile its lookups
+template <typename V>
+class KeyframeMap {
+protected:
+    std::vector<int> frames;
+    std::vector<V> values;
+    uint32_t version = 0;
+
+    size_t lowerBound(int frame) const {
+        return std::lower_bound(frames.begin(), frames.end(), frame) - frames.begin();
+    }
+public:
+    class iterator {
+    protected:
+        const KeyframeMap* map;
+        size_t idx;
+    public:
+        iterator(const KeyframeMap* map, size_t idx): map(map), idx(idx) {}
+
+        std::pair<int, const V&> operator*() const { return { map->frames[idx], map->values[idx] }; }
+        iterator& operator++() { idx++; return *this; }
+        bool operator==(const iterator& other) const { return idx == other.idx; }
+    };
+
+    V& operator[](int frame) {
+        version++;
+
+        size_t idx = lowerBound(frame);
+        if (idx == frames.size() || frames[idx] != frame) {
+            frames.insert(frames.begin() + idx, frame);
+            values.insert(values.begin() + idx, V {});
+        }
+        return values[idx];
+    }
+
+    void erase(int frame) {
+        size_t idx = lowerBound(frame);
+        if (idx == frames.size() || frames[idx] != frame) return;
+
+        frames.erase(frames.begin() + idx);
+        values.erase(values.begin() + idx);
+        version++;
+    }
+
+    bool contains(int frame) const {
+        size_t idx = lowerBound(frame);
+        return idx < frames.size() && frames[idx] == frame;
+    }
+
+    // index of the keyframe at `frame`, or -1
+    int indexOf(int frame) const {
+        size_t idx = lowerBound(frame);
+        return idx < frames.size() && frames[idx] == frame ? (int)idx : -1;
+    }
+
+    size_t size() const { return frames.size(); }
+    bool empty() const { return frames.empty(); }
+
+    const std::vector<int>& getFrames() const { return frames; }
+    int frameAt(size_t idx) const { return frames[idx]; }
+    const V& valueAt(size_t idx) const { return values[idx]; }
+
+    uint32_t getVersion() const { return version; }
+
+    iterator begin() const { return { this, 0 }; }
+    iterator end() const { return { this, frames.size() }; }
+};
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <array>
 
@@ -278,4 +279,22 @@ namespace animation {
     /// @param easing The easing.
     /// @return The easing function.
     EasingFunction getEasingFunction(Easing easing, EasingMode mode);
+
+    /// @brief Function pointer for an easing applied to a whole array.
+    /// @param values Times from 0 to 1, replaced by their `x` values.
+    /// @param count Number of values.
+    using EasingBatchFunction = void (*)(double* values, size_t count);
+
+    /// @brief Gets the batch version of an easing function.
+    /// @note Same as calling `function` on every value, but the easing is inlined into
+    /// a plain loop the compiler can vectorize where the math allows it.
+    /// @param function One of `EASING_FUNCTIONS`.
+    /// @return The batch function, or nullptr if `function` isn't in the table.
+    EasingBatchFunction getEasingBatchFunction(EasingFunction function);
+
+    /// @brief Eases every value in place.
+    /// @param function The easing function, anything not in `EASING_FUNCTIONS` is called per value.
+    /// @param values Times from 0 to 1, replaced by their `x` values.
+    /// @param count Number of values.
+    void easeBatch(EasingFunction function, double* values, size_t count);
 }
\ No newline at end of file
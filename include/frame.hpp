@@ -1,5 +1,6 @@
 #pragma once
 
+#include <optional>
 #include <vector>
 #include <common.hpp>
 
@@ -9,6 +10,14 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <renderer/batch.hpp>
+
+// texture pixels of a frame, from the bottom left like gl_FragCoord
+struct PixelRect {
+    int x, y;
+    int width, height;
+};
+
 class Frame {
 protected:
     enum class ShapeType {
@@ -16,22 +25,45 @@ protected:
         Circle
     };
 
+    void create();
     void primitiveDraw(Transform transform, Vector2D size, RGBAColor color, ShapeType type = ShapeType::Rect);
+    // queues the quad, or only measures it between beginMeasure / endMeasure
+    void submit(QuadBatch::Program program, std::array<GLuint, 3> textures, const Quad& quad);
     std::vector<unsigned char> imageData;
+
+    bool measuring = false;
+    // what's been measured so far, in texture pixels of the full frame
+    float measuredMinX, measuredMinY, measuredMaxX, measuredMaxY;
+
+    // the perspective camera everything is seen through
+    glm::mat4 createCameraMatrix();
+    // clip space of the full frame to clip space of the part the texture covers
+    glm::mat4 createViewMatrix();
 public:
+    // what everything is laid out in (the project resolution, usually)
     int width;
     int height;
 
+    // the texture is `scale` times that, draws land in the same place just with fewer pixels
+    float scale = 1.f;
+    int textureWidth;
+    int textureHeight;
+    // where the texture sits in the full frame, in texture pixels. 0, 0 unless the frame
+    // only covers part of it (a clip's static cache, see VideoTrack::drawClip)
+    int viewX = 0;
+    int viewY = 0;
+
+    // with the software backend both are the same SoftwareRasterizer image
     GLuint fbo;
     GLuint textureID;
 
-    GLuint shapeShaderProgram;
-    GLuint texShaderProgram;
-    GLuint texYUVShaderProgram;
-    // GLuint rectVAO, rectVBO;
-    GLuint VAO, VBO, EBO;
+    Frame(int width, int height, float scale = 1.f);
+    // laid out like a full width x height frame, but the texture only covers `view` of it
+    Frame(int width, int height, float scale, PixelRect view);
+    ~Frame();
 
-    Frame(int width, int height);
+    Frame(const Frame&) = delete;
+    Frame& operator=(const Frame&) = delete;
 
     void clearFrame(RGBAColor color = { 0, 0, 0, 255 });
 
@@ -42,8 +74,31 @@ public:
     void drawLine(Vector2D start, Vector2D end, RGBAColor color, int thickness = 1);
     void drawCircle(Transform transform, int radius, RGBAColor color, bool filled = true);
 
-    void drawTexture(GLuint texture, Vector2D size, Transform transform, GLuint VAO, GLuint VBO, GLuint EBO, float opacity = 1.f);
-    void drawTextureYUV(GLuint textureY, GLuint textureU, GLuint textureV, Vector2D size, Transform transform, GLuint VAO, GLuint VBO, GLuint EBO, float opacity = 1.f);
+    // draws are queued in QuadBatch, they land in the texture on flush()
+    void drawTexture(GLuint texture, Vector2D size, Transform transform, float opacity = 1.f);
+    void drawTextureYUV(GLuint textureY, GLuint textureU, GLuint textureV, Vector2D size, Transform transform, float opacity = 1.f);
+    // composites a premultiplied frame of the same size (and scale) over this one, pixel for pixel
+    // a layer that only covers part of the frame is only drawn over that part
+    void drawLayer(Frame* layer, float opacity = 1.f);
+
+    // until endMeasure, draws don't land anywhere, they only add up the pixels they'd cover
+    void beginMeasure();
+    // those pixels in the full frame (padded for filtering), nullopt if nothing would show
+    std::optional<PixelRect> endMeasure();
+    bool isMeasuring() const { return measuring; }
+    // for draws that don't go through submit (text), `matrix` takes the box to clip space
+    void measure(const glm::mat4& matrix, Vector2DF min, Vector2DF max);
+
+    // texture pixels covering `size` layout units at `scale`
+    static int textureSizeFor(int size, float scale);
+    // the texture size of the whole frame, what textureWidth / textureHeight are for full frames
+    int getFullTextureWidth() const { return textureSizeFor(width, scale); }
+    int getFullTextureHeight() const { return textureSizeFor(height, scale); }
+
+    // submits any draws still queued for this frame
+    void flush();
+    // the color texture with every queued draw in it
+    GLuint getTexture();
 
     // 0.5, 0.5 = center
     // 0, 0 = top left
@@ -53,5 +108,6 @@ public:
     glm::mat4 createBaseMatrix(Vector2DF anchorPoint = { 0.5, 0.5 });
     glm::mat4 createModelFromTransform(Transform transform, Vector2D pos, Vector2D size, bool reverseY = false);
 
-    std::vector<unsigned char> getFrameData();
+    // synchronous readback, use ReadbackRing where stalling matters
+    const std::vector<unsigned char>& getFrameData();
 };
\ No newline at end of file
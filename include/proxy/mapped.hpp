@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// read-only memory map of a whole file
+class MappedFile {
+protected:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+#ifdef WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    // asks the OS to start reading [offset, offset + length) in, without waiting for it
+    void willNeed(size_t offset, size_t length) const;
+
+    bool isOpen() const { return data != nullptr; }
+    std::span<const uint8_t> bytes() const { return { data, size }; }
+};
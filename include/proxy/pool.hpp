@@ -0,0 +1,32 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ZSTD_DCtx_s;
+
+// a few threads shared by every proxy reader for decompressing frames ahead of playback
+// each worker keeps its own zstd context, jobs get handed the one they run on
+class ProxyDecodePool {
+public:
+    using Job = std::function<void(ZSTD_DCtx_s*)>;
+protected:
+    std::vector<std::thread> workers;
+    std::deque<Job> jobs;
+    std::mutex jobsMutex;
+    std::condition_variable jobsCv;
+    bool stopping = false;
+
+    ProxyDecodePool(int workerCount);
+    void workerLoop();
+public:
+    ~ProxyDecodePool();
+
+    static ProxyDecodePool& get();
+
+    void submit(Job job);
+};
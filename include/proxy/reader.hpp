@@ -0,0 +1,85 @@
+#pragma once
+
+#include <proxy/vpf.hpp>
+#include <proxy/mapped.hpp>
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+struct ZSTD_DCtx_s;
+
+// random access into a .vpf proxy
+// the whole file is memory mapped, so compressed frames are read straight out of
+// the page cache and decompressed into pooled buffers, ahead of time when prefetched
+class ProxyReader : public std::enable_shared_from_this<ProxyReader> {
+public:
+    using Buffer = std::shared_ptr<std::vector<uint8_t>>;
+    // packed yuv420p, stays valid for as long as it's held
+    using FrameData = std::shared_ptr<const std::vector<uint8_t>>;
+
+    // how far ahead of the playhead frames get decompressed
+    static constexpr int PREFETCH_FRAMES = 8;
+protected:
+    struct CachedFrame {
+        Buffer buffer;
+        // false while a pool worker is still decompressing into it
+        bool ready = false;
+    };
+
+    std::string path;
+    vpf::Header header;
+    std::vector<vpf::IndexEntry> index;
+    MappedFile file;
+
+    // used by synchronous reads (seeks, timeline previews)
+    std::mutex dctxMutex;
+    ZSTD_DCtx_s* dctx = nullptr;
+
+    std::mutex framesMutex;
+    std::condition_variable framesCv;
+    std::map<int, CachedFrame> frames;
+    std::vector<Buffer> freeBuffers;
+
+    ProxyReader(std::string path);
+    bool load();
+
+    int clampFrame(int frame) const;
+    bool decompress(ZSTD_DCtx_s* ctx, int frame, std::vector<uint8_t>& out) const;
+
+    // these expect framesMutex to be held
+    Buffer acquireBuffer();
+    // drops decoded frames outside [first, first + count)
+    void trim(int first, int count);
+public:
+    ~ProxyReader();
+
+    // nullptr if the file is missing or not a valid proxy
+    static std::shared_ptr<ProxyReader> open(const std::string& path);
+
+    // the compressed frame, pointing into the mapping (no copy)
+    std::span<const uint8_t> getCompressed(int frame) const;
+
+    // decompresses `frame` into `out` (resized to getFrameSize()), skipping the prefetched frames
+    // frames past the end return the last one. thread safe
+    bool readFrame(int frame, std::vector<uint8_t>& out);
+
+    // a prefetched frame if there is one (waiting on it if it's in flight),
+    // otherwise decompresses it right away. nullptr on failure
+    FrameData getFrame(int frame);
+
+    // queues [first, first + count) on the decode pool and forgets anything outside of it
+    void prefetch(int first, int count = PREFETCH_FRAMES);
+
+    int getWidth() const { return header.width; }
+    int getHeight() const { return header.height; }
+    int getSourceWidth() const { return header.sourceWidth; }
+    int getSourceHeight() const { return header.sourceHeight; }
+    int getFrameCount() const { return header.frameCount; }
+    double getFPS() const { return header.getFPS(); }
+    size_t getFrameSize() const { return header.getFrameSize(); }
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <binary/reader.hpp>
+#include <binary/writer.hpp>
+
+#include <cstdint>
+#include <string>
+
+// video proxy format, see vpf.md
+namespace vpf {
+    constexpr char MAGIC[4] = { 'V', 'P', 'F', 'X' };
+    constexpr uint16_t VERSION = 1;
+    constexpr int ZSTD_LEVEL = 3;
+
+    // proxies never go above this, they're only for scrubbing / preview
+    constexpr int MAX_WIDTH = 1280;
+    constexpr int MAX_HEIGHT = 720;
+
+    struct Header {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t frameCount = 0;
+        uint64_t indexOffset = 0;
+
+        // version 1
+        uint32_t fpsNum = 30;
+        uint32_t fpsDen = 1;
+        uint32_t sourceWidth = 0;
+        uint32_t sourceHeight = 0;
+
+        static constexpr size_t SIZE = 4 + 2 + 4 + 4 + 4 + 8 + 4 + 4 + 4 + 4;
+
+        void write(qn::HeapByteWriter& writer) const;
+        // false if the magic or version don't match
+        bool read(qn::ByteReader& reader);
+
+        double getFPS() const { return fpsDen == 0 ? 0.0 : (double)fpsNum / (double)fpsDen; }
+        // every frame is tightly packed yuv420p
+        size_t getFrameSize() const;
+    };
+
+    struct IndexEntry {
+        uint32_t frame = 0;
+        uint64_t offset = 0;
+        uint32_t size = 0;
+
+        static constexpr size_t SIZE = 4 + 8 + 4;
+    };
+
+    std::string proxyPathFor(const std::string& source);
+    // true if there is a proxy for `source` that is newer than it
+    bool hasProxy(const std::string& source);
+
+    // bumped every time a proxy finishes writing, so clips know to look again
+    int getGeneration();
+    void bumpGeneration();
+}
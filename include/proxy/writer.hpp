@@ -0,0 +1,21 @@
+#pragma once
+
+#include <proxy/vpf.hpp>
+
+#include <string>
+
+// transcodes a video into a .vpf proxy next to it
+// the file is written as <proxy>.part and only renamed once it's complete,
+// so a reader never sees a half written proxy
+class ProxyWriter {
+protected:
+    std::string sourcePath;
+    std::string outputPath;
+public:
+    ProxyWriter(std::string sourcePath);
+
+    // blocking, meant to run on a background thread
+    bool write();
+
+    const std::string& getOutputPath() const { return outputPath; }
+};
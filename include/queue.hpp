@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <semaphore>
+#include <thread>
+
+// bounded multi-producer multi-consumer queue
+// (dmitry vyukov's design: every cell carries a sequence number, so producers
+// and consumers only ever race on a single CAS of the head / tail counter)
+template <typename T>
+class BoundedQueue {
+protected:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+
+    alignas(CACHE_LINE) std::atomic<size_t> enqueuePos = 0;
+    alignas(CACHE_LINE) std::atomic<size_t> dequeuePos = 0;
+
+    // only used by the blocking push / pop
+    std::counting_semaphore<> freeSlots;
+    std::counting_semaphore<> usedSlots { 0 };
+
+    alignas(CACHE_LINE) std::atomic<int> pushStalls = 0;
+    std::atomic<int> popStalls = 0;
+
+    static size_t roundCapacity(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        return size;
+    }
+public:
+    explicit BoundedQueue(size_t capacity):
+        cells(new Cell[roundCapacity(capacity)]),
+        mask(roundCapacity(capacity) - 1),
+        freeSlots(static_cast<std::ptrdiff_t>(roundCapacity(capacity)))
+    {
+        for (size_t i = 0; i <= mask; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // only moves out of `value` if it was actually pushed
+    bool tryEmplace(T& value) {
+        Cell* cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // non-blocking, returns false if the queue is full
+    bool tryPush(T value) {
+        return tryEmplace(value);
+    }
+
+    // non-blocking, returns false if the queue is empty
+    bool tryPop(T& out) {
+        Cell* cell;
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        out = std::move(cell->data);
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // blocking versions, these sleep instead of spinning when the queue is full / empty
+    // (don't mix them with tryPush / tryPop on the same queue)
+    void push(T value) {
+        if (!freeSlots.try_acquire()) {
+            pushStalls.fetch_add(1, std::memory_order_relaxed);
+            freeSlots.acquire();
+        }
+        // a free slot was counted, but a consumer that popped the cell we're
+        // about to reuse may still be reading it out, so this can briefly fail
+        while (!tryEmplace(value)) std::this_thread::yield();
+        usedSlots.release();
+    }
+
+    T pop() {
+        if (!usedSlots.try_acquire()) {
+            popStalls.fetch_add(1, std::memory_order_relaxed);
+            usedSlots.acquire();
+        }
+        T value;
+        while (!tryPop(value)) std::this_thread::yield();
+        freeSlots.release();
+        return value;
+    }
+
+    // how many times a blocking push found the queue full (back-pressure)
+    // and a blocking pop found it empty (starvation)
+    int getPushStalls() const { return pushStalls.load(std::memory_order_relaxed); }
+    int getPopStalls() const { return popStalls.load(std::memory_order_relaxed); }
+};
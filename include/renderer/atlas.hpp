@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <glad/include/glad/gl.h>
+#include <SDL3/SDL_opengl.h>
+
+// single channel texture that glyph bitmaps get packed into on demand,
+// shelf by shelf. starts small and doubles in height when it runs out of room
+//
+// regions are in pixels, the texture can grow after a glyph is inserted
+// so uvs should be worked out from getWidth() / getHeight() at draw time
+class GlyphAtlas {
+public:
+    struct Region {
+        int x = 0, y = 0;
+        int width = 0, height = 0;
+    };
+
+    static constexpr int WIDTH = 2048;
+    static constexpr int INITIAL_HEIGHT = 512;
+    static constexpr int MAX_HEIGHT = 8192;
+    // empty pixels around each glyph so linear filtering doesn't pick up the neighbours
+    static constexpr int PADDING = 1;
+protected:
+    struct Shelf {
+        int y;
+        int height;
+        int cursorX;
+    };
+
+    GLuint texture = 0;
+    int height = 0;
+
+    std::vector<Shelf> shelves;
+    // cpu copy, needed to carry the contents over when the texture grows
+    std::vector<uint8_t> pixels;
+
+    bool grow();
+public:
+    GlyphAtlas();
+    ~GlyphAtlas();
+
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+    // copies a `width` x `height` bitmap (rows `pitch` bytes apart) into the atlas
+    // nullopt if it doesn't fit even at MAX_HEIGHT
+    std::optional<Region> insert(int width, int height, const uint8_t* bitmap, int pitch);
+
+    GLuint getTexture() const { return texture; }
+    int getWidth() const { return WIDTH; }
+    int getHeight() const { return height; }
+};
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include <clips/clip.hpp>
@@ -11,23 +12,41 @@
 
 struct AudioRenderFile {
     ma_decoder decoder;
-    std::string_view path;
-    float startTime;
-    float endTime;
+    std::string path;
+    // in samples (per channel) on the output timeline
+    int64_t startSample;
+    int64_t endSample;
     std::shared_ptr<NumberProperty> volume;
 };
 
+// mixes every audio clip of a project into interleaved stereo float blocks
 class AudioRenderer {
 protected:
-    ma_encoder encoder;
     ma_decoder_config decoderConfig;
-    std::vector<AudioRenderFile> clips;
+    // decoders keep pointers into themselves, so they can't be moved around
+    std::vector<std::unique_ptr<AudioRenderFile>> clips;
+    std::vector<float> scratch;
 
-    std::string outputPath;
-    float length;
+    int64_t lengthSamples;
+    int64_t currentSample = 0;
+    float fps;
 public:
-    AudioRenderer(std::string_view outputPath, float length);
+    static constexpr int SAMPLE_RATE = 48000;
+    static constexpr int CHANNELS = 2;
+
+    AudioRenderer(float length, float fps);
+    ~AudioRenderer();
+
+    AudioRenderer(const AudioRenderer&) = delete;
+    AudioRenderer& operator=(const AudioRenderer&) = delete;
 
     void addClip(std::string path, float start, float end, std::shared_ptr<NumberProperty> volume);
-    void render(float fps);
+
+    // mixes the next `frameCount` sample frames into `out` (frameCount * CHANNELS floats).
+    // returns how many frames were mixed, less than asked for at the end of the timeline
+    int mix(float* out, int frameCount);
+
+    int64_t getPosition() const { return currentSample; }
+    int64_t getLength() const { return lengthSamples; }
+    bool isDone() const { return currentSample >= lengthSamples; }
 };
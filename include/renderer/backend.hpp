@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include <glad/include/glad/gl.h>
+#include <SDL3/SDL_opengl.h>
+
+// what Frames, QuadBatch and the text renderer draw with. picked once at startup,
+// before anything is created, and never changed after: a texture made by one
+// backend means nothing to the other
+enum class RenderBackend {
+    OpenGL = 0,
+    // SoftwareRasterizer, doesn't need a gl context at all
+    Software = 1,
+};
+
+const std::array<const char*, 2> RENDER_BACKEND_NAMES = {
+    "opengl",
+    "software",
+};
+
+namespace backend {
+    RenderBackend get();
+    void set(RenderBackend backend);
+    bool parse(const std::string& name, RenderBackend& out);
+
+    inline bool isSoftware() { return get() == RenderBackend::Software; }
+}
+
+// textures that clips sample from, created through whichever backend is active
+// handles are GLuints either way, the software backend hands out its own
+namespace texture {
+    enum class Format {
+        R8,
+        RGB8,
+        RGBA8
+    };
+
+    enum class Wrap {
+        Clamp,
+        Repeat
+    };
+
+    // linear filtering, no storage until the first upload()
+    GLuint create(Wrap wrap = Wrap::Clamp);
+    // (re)allocates and fills the whole texture, rows tightly packed, first row at v = 0
+    void upload(GLuint texture, Format format, int width, int height, const uint8_t* data);
+    // replaces a rectangle of an uploaded texture, rows `stride` pixels apart
+    void update(GLuint texture, Format format, int x, int y, int width, int height, const uint8_t* data, int stride);
+    void destroy(GLuint texture);
+}
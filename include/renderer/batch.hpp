@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <glad/include/glad/gl.h>
+#include <SDL3/SDL_opengl.h>
+
+// already in clip space, so one batch can hold quads with different transforms
+struct QuadVertex {
+    float x, y, z, w;
+    float u, v;
+    // shapes: fill color. textures: (1, 1, 1, opacity)
+    float r, g, b, a;
+    // shapes only: type, radius, center x, center y (in framebuffer pixels)
+    float shapeType, radius, centerX, centerY;
+};
+
+using Quad = std::array<QuadVertex, 4>;
+
+// collects the quads drawn into Frames and submits runs of them that share a target,
+// program and textures as a single draw, streamed through one shared vertex buffer
+//
+// quads are never reordered (layers blend over each other), so a run ends whenever
+// the state changes. GL thread only
+//
+// with RenderBackend::Software the runs go to SoftwareRasterizer instead of gl
+class QuadBatch {
+public:
+    enum class Program {
+        Shape,
+        Texture,
+        TextureYUV,
+        // a premultiplied track layer being composited, see VideoTrack::renderLayer
+        Layer
+    };
+
+    static constexpr int MAX_QUADS = 4096;
+protected:
+    struct DrawState {
+        GLuint fbo = 0;
+        int width = 0, height = 0;
+        Program program = Program::Shape;
+        std::array<GLuint, 3> textures = {};
+
+        bool operator==(const DrawState& other) const = default;
+    };
+
+    DrawState state;
+    std::vector<QuadVertex> pending;
+
+    GLuint VAO = 0, VBO = 0, EBO = 0;
+    // in quads, the buffer is orphaned and refilled from 0 once it's full
+    int writeOffset = 0;
+
+    int drawCalls = 0;
+    int quadCount = 0;
+
+    QuadBatch() = default;
+    void init();
+public:
+    static QuadBatch& get();
+
+    void add(GLuint fbo, int width, int height, Program program, std::array<GLuint, 3> textures, const Quad& quad);
+
+    // submits whatever is queued
+    void flush();
+    // only if what's queued draws into `fbo`
+    void flush(GLuint fbo);
+    // throws away anything queued for `fbo` (it's about to be cleared anyway)
+    void discard(GLuint fbo);
+
+    // draw calls / quads submitted since the last reset, for profiling
+    int getDrawCalls() const { return drawCalls; }
+    int getQuadCount() const { return quadCount; }
+    void resetStats() { drawCalls = 0; quadCount = 0; }
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <memory>
+
+#include <renderer/pipeline.hpp>
+#include <renderer/settings.hpp>
+
+class Video;
+
+struct ExportStats {
+    int frames = 0;
+    // time spent rendering + encoding (audio is encoded alongside the video)
+    double videoSeconds = 0.0;
+    // time for the whole export, including setup and teardown
+    double totalSeconds = 0.0;
+
+    // per stage timing of the video export
+    PipelineStats pipeline;
+
+    double fps() const { return videoSeconds > 0.0 ? frames / videoSeconds : 0.0; }
+};
+
+// runs a full export (video and mixed audio, in one pass) of a project to a file
+// shared between the export menu and the headless renderer
+class Exporter {
+protected:
+    std::shared_ptr<Video> video;
+    std::string outputPath;
+    ExportSettings settings;
+
+    ExportStats stats;
+public:
+    Exporter(std::shared_ptr<Video> video, std::string outputPath, ExportSettings settings = {});
+
+    // returns false if any stage of the export failed
+    bool run();
+
+    const ExportStats& getStats() const { return stats; }
+};
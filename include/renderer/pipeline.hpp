@@ -0,0 +1,128 @@
+#pragma once
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <queue.hpp>
+#include <renderer/readback.hpp>
+
+class Frame;
+
+struct PipelineStats {
+    int frames = 0;
+
+    // GL thread: compositing (time between submits) and queueing / mapping readbacks
+    double renderSeconds = 0.0;
+    double readbackSeconds = 0.0;
+    // summed over all conversion workers
+    double convertSeconds = 0.0;
+    // encoder thread, sending frames and writing packets
+    double encodeSeconds = 0.0;
+
+    // back-pressure: how often each stage had to wait on the next one
+    int readbackWaits = 0;  // GL thread waited on the GPU to finish a readback
+    int convertStalls = 0;  // GL thread waited on a worker to free a readback buffer
+    int encodeStalls = 0;   // a worker waited on the encoder to free an AVFrame
+    int encoderStarved = 0; // the encoder had nothing to do
+};
+
+// staged export: the GL thread composites and queues readbacks, a pool of
+// workers converts the mapped buffers into AVFrames, and a dedicated encoder
+// thread feeds them to libavcodec in order. stages are connected by bounded
+// queues, so a slow stage throttles the ones before it instead of piling up memory
+class ExportPipeline {
+public:
+    // per worker state, freed when the worker exits
+    struct ConvertContext {
+        SwsContext* sws = nullptr;
+    };
+
+    // GL thread, queue the frame's readback into the ring
+    using ReadbackFn = std::function<bool(Frame* frame, ReadbackRing& ring, int frameNum)>;
+    // worker threads, fill `out` from a mapped readback buffer
+    using ConvertFn = std::function<bool(std::span<const uint8_t> data, AVFrame* out, ConvertContext& ctx)>;
+    // encoder thread, frames arrive in order
+    using EncodeFn = std::function<bool(AVFrame* frame)>;
+protected:
+    using clock = std::chrono::steady_clock;
+
+    struct ConvertJob {
+        std::span<const uint8_t> data;
+        int frameNum = -1;
+        std::atomic<bool> done = false;
+    };
+
+    struct EncodeJob {
+        int frameNum = -1;
+        AVFrame* frame = nullptr;
+        bool valid = false;
+    };
+
+    ReadbackFn readbackFn;
+    ConvertFn convertFn;
+    EncodeFn encodeFn;
+
+    std::unique_ptr<ReadbackRing> ring;
+    // mapped slots handed to the workers, oldest first (GL thread only)
+    std::deque<std::shared_ptr<ConvertJob>> inFlight;
+
+    BoundedQueue<std::shared_ptr<ConvertJob>> convertQueue;
+    BoundedQueue<EncodeJob> encodeQueue;
+    // free AVFrames, workers take one per job and the encoder gives it back
+    BoundedQueue<AVFrame*> framePool;
+    std::vector<AVFrame*> frames;
+
+    std::vector<std::thread> workers;
+    std::thread encoderThread;
+
+    std::atomic<bool> failed = false;
+    bool finished = false;
+    int submitted = 0;
+
+    clock::time_point lastSubmit;
+    std::chrono::nanoseconds renderTime { 0 };
+    std::chrono::nanoseconds readbackTime { 0 };
+    std::atomic<int64_t> convertNs = 0;
+    std::atomic<int64_t> encodeNs = 0;
+    int readbackWaits = 0;
+    int convertStalls = 0;
+
+    void dispatchOne();
+    void releaseDone(bool wait);
+
+    void workerLoop();
+    void encoderLoop();
+public:
+    ExportPipeline(
+        size_t readbackSize, int workerCount,
+        AVPixelFormat format, int width, int height,
+        ReadbackFn readbackFn, ConvertFn convertFn, EncodeFn encodeFn
+    );
+    ~ExportPipeline();
+
+    ExportPipeline(const ExportPipeline&) = delete;
+    ExportPipeline& operator=(const ExportPipeline&) = delete;
+
+    // GL thread. only blocks when the later stages are behind
+    bool submit(Frame* frame);
+    // GL thread. drains every stage and joins the threads
+    bool finish();
+
+    bool isOk() const { return !failed; }
+    PipelineStats getStats() const;
+
+    // a reasonable worker count for this machine
+    static int defaultWorkerCount();
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+
+// cpu pixel kernels, thin wrappers over libyuv so every call site gets its
+// simd paths (sse2 / avx2 / neon, picked at runtime) without rolling its own
+//
+// "rgba" is r, g, b, a in memory (what gl reads back and stb loads), which libyuv calls ABGR
+// yuv is bt.601 limited range, same as swscale's default and YUVConverter
+// strides are in bytes. the bool ones are false if libyuv turned the arguments down
+namespace pixel {
+    enum class Filter {
+        // averages every source pixel under the destination one, for shrinking by a lot
+        Box,
+        Bilinear
+    };
+
+    bool rgbaToI420(
+        const uint8_t* rgba, int rgbaStride,
+        uint8_t* y, int yStride, uint8_t* u, int uStride, uint8_t* v, int vStride,
+        int width, int height
+    );
+    bool rgbaToNV12(
+        const uint8_t* rgba, int rgbaStride,
+        uint8_t* y, int yStride, uint8_t* uv, int uvStride,
+        int width, int height
+    );
+    bool i420ToRGBA(
+        const uint8_t* y, int yStride, const uint8_t* u, int uStride, const uint8_t* v, int vStride,
+        uint8_t* rgba, int rgbaStride,
+        int width, int height
+    );
+    bool nv12ToRGBA(
+        const uint8_t* y, int yStride, const uint8_t* uv, int uvStride,
+        uint8_t* rgba, int rgbaStride,
+        int width, int height
+    );
+    // r, g, b -> r, g, b, 255
+    bool rgbToRGBA(const uint8_t* rgb, int rgbStride, uint8_t* rgba, int rgbaStride, int width, int height);
+
+    bool scaleRGBA(
+        const uint8_t* src, int srcStride, int srcWidth, int srcHeight,
+        uint8_t* dst, int dstStride, int dstWidth, int dstHeight,
+        Filter filter
+    );
+    // chroma planes are half the size (rounded up) of the luma on both sides
+    bool scaleI420(
+        const uint8_t* srcY, int srcYStride, const uint8_t* srcU, int srcUStride, const uint8_t* srcV, int srcVStride,
+        int srcWidth, int srcHeight,
+        uint8_t* dstY, int dstYStride, uint8_t* dstU, int dstUStride, uint8_t* dstV, int dstVStride,
+        int dstWidth, int dstHeight,
+        Filter filter
+    );
+
+    // `width` bytes of each of `height` rows, for repacking planes between padded and tight strides
+    void copyPlane(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride, int width, int height);
+}
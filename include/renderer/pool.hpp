@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+
+#include <frame.hpp>
+
+// recycles render targets so steady state rendering (playback, export, thumbnails)
+// doesn't create and destroy fbos and textures every frame
+//
+// acquire() hands out a lease: a shared_ptr whose deleter gives the frame back to the
+// pool instead of destroying it. frames are only reused for the exact same size, scale
+// and texture size, and come back uncleared. every Frame is RGBA8, so the size is the whole key
+//
+// idle frames are dropped oldest first to stay under the budget, leased ones always
+// count towards it but are never taken away. GL thread only
+class FramePool {
+public:
+    using Lease = std::shared_ptr<Frame>;
+
+    static constexpr size_t DEFAULT_BUDGET = 1024ull * 1024 * 1024;
+protected:
+    // most recently returned at the front
+    std::list<std::unique_ptr<Frame>> idle;
+
+    size_t budget = DEFAULT_BUDGET;
+    // every frame the pool made that's still alive, leased or idle
+    size_t usage = 0;
+    int leased = 0;
+    int created = 0;
+
+    FramePool() = default;
+
+    static size_t sizeOf(const Frame& frame);
+    void release(Frame* frame);
+    // drops idle frames until `extra` more bytes would fit
+    void trim(size_t extra = 0);
+public:
+    static FramePool& get();
+
+    Lease acquire(int width, int height, float scale = 1.f);
+    // a frame whose texture only covers `view`, reused for any view of the same size
+    Lease acquire(int width, int height, float scale, PixelRect view);
+
+    void setBudget(size_t bytes);
+    // destroys every idle frame
+    void clear();
+
+    size_t getBudget() const { return budget; }
+    size_t getUsage() const { return usage; }
+    int getLeased() const { return leased; }
+    int getIdle() const { return idle.size(); }
+    // frames allocated over the pool's lifetime, stays flat once rendering is warmed up
+    int getCreated() const { return created; }
+};
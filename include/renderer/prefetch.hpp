@@ -0,0 +1,56 @@
+#pragma once
+
+#include <future>
+#include <memory>
+#include <vector>
+
+#include <clips/clip.hpp>
+
+class Video;
+
+// works out every keyframed property of every video clip for a block of export frames
+// on worker threads, while the frames before it are rendered. the properties are pointed
+// at the results, so processKeyframe on the render thread just applies them
+//
+// two blocks are kept: the one being rendered and the one being evaluated. nothing may
+// edit the video's clips while this is alive, Video::render holds one for its loop
+class PropertyPrefetch {
+public:
+    static constexpr int BLOCK_FRAMES = 120;
+protected:
+    struct Target {
+        std::shared_ptr<ClipPropertyBase> property;
+        // the frames the clip is on screen for, inclusive
+        int firstFrame;
+        int lastFrame;
+    };
+
+    struct Block {
+        int startFrame = 0;
+        int count = 0;
+        // one per target
+        std::vector<KeyframeSamples> samples;
+        std::vector<std::future<void>> pending;
+    };
+
+    std::vector<Target> targets;
+    Block blocks[2];
+    // the block the properties point at, -1 before the first advance
+    int current = -1;
+    int frameCount;
+    int workerCount;
+
+    void launch(Block& block, int startFrame);
+    void wait(Block& block);
+public:
+    PropertyPrefetch(Video& video);
+    ~PropertyPrefetch();
+
+    PropertyPrefetch(PropertyPrefetch const&) = delete;
+    PropertyPrefetch& operator=(PropertyPrefetch const&) = delete;
+
+    // call before rendering each frame, in order
+    void advance(int frame);
+
+    size_t getTargetCount() const { return targets.size(); }
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+
+enum class PreviewQuality {
+    Full = 0,
+    Half = 1,
+    Quarter = 2,
+    Eighth = 3,
+    Auto = 4,
+};
+
+const std::array<const char*, 5> PREVIEW_QUALITY_NAMES = {
+    "Full",
+    "Half",
+    "Quarter",
+    "Eighth",
+    "Auto",
+};
+
+// picks the scale the viewport frame is rendered at
+// Auto never renders bigger than the player shows it, and while playing steps down
+// whenever rendering a frame takes too much of the frame's time (and back up once it doesn't)
+class PreviewScaler {
+public:
+    static constexpr std::array<float, 4> SCALES = { 1.f, 0.5f, 0.25f, 0.125f };
+    // frames averaged before Auto changes its mind
+    static constexpr int WINDOW = 8;
+protected:
+    std::array<double, WINDOW> samples = {};
+    int sampleCount = 0;
+    // index into SCALES
+    int playbackStep = 0;
+public:
+    // how long rendering the last preview frame took, and how long it was allowed to take
+    void addSample(double ms, double budgetMs);
+
+    // `displayScale` is how much the player window scales the frame down to fit
+    float getScale(PreviewQuality quality, float displayScale, bool playing) const;
+};
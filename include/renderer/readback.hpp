@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glad/include/glad/gl.h>
+#include <SDL3/SDL_opengl.h>
+
+class Frame;
+
+// ring of pixel buffer objects used to read frames back from the GPU
+// without stalling. reads are queued into the next free buffer and only
+// waited on (and mapped) once the ring is full, so the readback of frame N
+// overlaps with rendering frame N + 1 (and onwards)
+//
+// with the software backend the slots are plain memory, reads copy straight
+// out of the frame and are ready as soon as they're queued
+class ReadbackRing {
+protected:
+    struct Slot {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        // software backend only
+        std::vector<uint8_t> host;
+        int frameNum = -1;
+        bool mapped = false;
+    };
+
+    std::vector<Slot> slots;
+    size_t slotSize;
+
+    // next slot to write into / oldest slot still in flight
+    int head = 0;
+    int tail = 0;
+    int pending = 0;
+
+    // slots (from the tail) that have already been handed out by map()
+    int handedOut = 0;
+
+    bool recording = false;
+public:
+    ReadbackRing(int count, size_t slotSize);
+    ~ReadbackRing();
+
+    ReadbackRing(const ReadbackRing&) = delete;
+    ReadbackRing& operator=(const ReadbackRing&) = delete;
+
+    bool full() const { return pending == static_cast<int>(slots.size()); }
+    bool empty() const { return pending == 0; }
+    // slots queued but not mapped yet
+    int unmapped() const { return pending - handedOut; }
+    int getCount() const { return static_cast<int>(slots.size()); }
+    size_t getSlotSize() const { return slotSize; }
+
+    // start recording reads into the next free slot, the ring must not be full
+    bool begin(int frameNum);
+    // read a framebuffer attachment into the current slot at `offset` bytes
+    void read(GLuint fbo, int width, int height, GLenum format, size_t offset = 0, GLenum attachment = GL_COLOR_ATTACHMENT0);
+    // fence the reads so they can be waited on later
+    void end();
+
+    // convenience for reading a whole RGBA frame
+    bool queue(Frame* frame, int frameNum);
+
+    // true if the oldest unmapped slot's reads have finished, so map() won't block
+    bool ready();
+
+    // waits for the oldest slot that hasn't been mapped yet and maps it.
+    // several slots can be mapped at once, each one's data is valid until it's released.
+    // returns an empty span if mapping failed (the slot still has to be released)
+    std::span<const uint8_t> map(int* frameNum = nullptr);
+    // unmaps and frees the oldest slot
+    void release();
+};
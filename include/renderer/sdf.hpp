@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <freetype/freetype.h>
+
+// signed distance field glyphs, rendered with freetype's sdf rasterizer
+// one set per font file is enough for any size, rotation or scale since
+// the edge is reconstructed in the shader
+//
+// sets are cached on disk under cache/fonts, keyed by the font path and
+// invalidated when the font file or any of the parameters below change
+namespace sdf {
+    constexpr char MAGIC[4] = { 'S', 'D', 'F', 'G' };
+    constexpr uint16_t VERSION = 1;
+
+    // distance (in pixels at the load size) the field extends past the outline
+    constexpr int SPREAD = 8;
+
+    struct Glyph {
+        char32_t codepoint = 0;
+        int width = 0, height = 0;
+        int bearingX = 0, bearingY = 0;
+        long advance = 0;
+        // 8 bit, 128 on the outline, higher inside
+        std::vector<uint8_t> bitmap;
+    };
+
+    std::string cachePathFor(const std::string& fontPath);
+
+    // sets the spread on `library`'s sdf renderer, once per library
+    void configure(FT_Library library);
+    // one glyph from an already sized face, false if freetype couldn't render it
+    bool renderGlyph(FT_Face face, char32_t codepoint, Glyph& out);
+
+    // rasterizes `codepoints` at `pixelSize`, going through the disk cache
+    // meant to run off the gl thread, it opens its own freetype instance
+    std::vector<Glyph> generate(const std::string& fontPath, int pixelSize, const std::vector<char32_t>& codepoints);
+}
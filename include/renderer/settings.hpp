@@ -0,0 +1,106 @@
+#pragma once
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/dict.h>
+}
+
+#include <array>
+#include <string>
+
+enum class ExportCodec {
+    H264 = 0,
+    HEVC = 1,
+    VP9 = 2,
+    AV1 = 3,
+    ProRes = 4,
+};
+
+const std::array<const char*, 5> EXPORT_CODEC_NAMES = {
+    "H.264",
+    "HEVC",
+    "VP9",
+    "AV1",
+    "ProRes",
+};
+
+// x264 style names, mapped onto each encoder's own speed knob
+enum class ExportPreset {
+    Ultrafast = 0,
+    Superfast = 1,
+    Veryfast = 2,
+    Faster = 3,
+    Fast = 4,
+    Medium = 5,
+    Slow = 6,
+    Slower = 7,
+    Veryslow = 8,
+};
+
+const std::array<const char*, 9> EXPORT_PRESET_NAMES = {
+    "ultrafast",
+    "superfast",
+    "veryfast",
+    "faster",
+    "fast",
+    "medium",
+    "slow",
+    "slower",
+    "veryslow",
+};
+
+enum class RateControl {
+    CRF = 0,
+    Bitrate = 1,
+};
+
+const std::array<const char*, 2> RATE_CONTROL_NAMES = {
+    "Constant quality (CRF)",
+    "Bitrate",
+};
+
+enum class EncoderThreading {
+    Auto = 0,
+    Frame = 1,
+    Slice = 2,
+};
+
+const std::array<const char*, 3> ENCODER_THREADING_NAMES = {
+    "Auto",
+    "Frame",
+    "Slice",
+};
+
+struct ExportSettings {
+    ExportCodec codec = ExportCodec::H264;
+    ExportPreset preset = ExportPreset::Medium;
+
+    RateControl rateControl = RateControl::CRF;
+    int crf = 23;
+    // kbit/s
+    int bitrate = 8000;
+
+    // 0 = let the encoder pick (usually one per core)
+    int threads = 0;
+    // frame threading is faster, slice threading has less latency
+    EncoderThreading threading = EncoderThreading::Auto;
+
+    int keyframeInterval = 12;
+    int maxBFrames = 2;
+
+    // highest CRF the current codec accepts
+    int maxCRF() const;
+
+    AVPixelFormat getPixelFormat() const;
+
+    // picks the best available encoder for the codec, nullptr if there is none
+    const AVCodec* findEncoder() const;
+
+    // fills in the codec context and encoder private options
+    void apply(AVCodecContext* ctx, AVDictionary** options) const;
+
+    // parses values like "h264", "prores", "veryfast" (case sensitive), returns false if unknown
+    static bool parseCodec(const std::string& name, ExportCodec& out);
+    static bool parsePreset(const std::string& name, ExportPreset& out);
+    static bool parseThreading(const std::string& name, EncoderThreading& out);
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <common.hpp>
+#include <renderer/batch.hpp>
+
+#include <glm/glm.hpp>
+
+// the cpu side of RenderBackend::Software: rasterizes what QuadBatch and the text
+// renderer would otherwise hand to gl, following the same shaders and blend state
+// (pixel centers, linear filtering, clamped output, straight / premultiplied blending)
+// so a frame comes out the same either way, give or take rounding
+//
+// targets are split into bands of TILE_ROWS rows that the worker threads take one at
+// a time. a band runs through every triangle in order, so draws still stack the way
+// they were queued. pixels are blended a span at a time with sse2 / neon
+//
+// images are stored bottom row first like a gl texture, so a Frame reads back the
+// same way. GL thread only (well, render thread, there is no gl here)
+class SoftwareRasterizer {
+public:
+    struct Image {
+        int width = 0, height = 0;
+        int channels = 4;
+        bool repeat = false;
+        std::vector<uint8_t> pixels;
+    };
+
+    static constexpr int TILE_ROWS = 32;
+protected:
+    // node based, so pointers handed out stay valid while others come and go
+    std::unordered_map<GLuint, Image> images;
+    GLuint nextId = 1;
+
+    std::vector<std::thread> workers;
+    std::mutex workMutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    // all under workMutex, indices are claimed one at a time
+    const std::function<void(int)>* job = nullptr;
+    int jobCount = 0;
+    int nextJob = 0;
+    int busyWorkers = 0;
+
+    SoftwareRasterizer();
+
+    void workerLoop();
+    // runs fn(0) .. fn(count - 1) across the workers and this thread, returns once all are done
+    void parallelFor(int count, const std::function<void(int)>& fn);
+public:
+    static SoftwareRasterizer& get();
+
+    GLuint createImage(bool repeat = false);
+    // nullptr for ids that were never made (or already destroyed)
+    Image* getImage(GLuint id);
+    void destroyImage(GLuint id);
+
+    void clear(GLuint target, RGBAColor color);
+    void drawQuads(GLuint target, QuadBatch::Program program, const std::array<GLuint, 3>& textures, const QuadVertex* vertices, int quads);
+    // a text layout's triangles, `vertices` is (x, y, u, v) each, see TextRenderer::drawLayout
+    void drawText(GLuint target, GLuint atlas, bool sdf, RGBAColor color, const glm::mat4& matrix, const float* vertices, int vertexCount);
+
+    int getThreadCount() const { return workers.size() + 1; }
+};
@@ -1,13 +1,18 @@
 #pragma once
 
+#include <future>
+#include <memory>
 #include <unordered_map>
 #include <string>
+#include <vector>
 
 #include <glad/include/glad/gl.h>
 #include <SDL3/SDL_opengl.h>
 
 #include <common.hpp>
 #include <frame.hpp>
+#include <renderer/atlas.hpp>
+#include <renderer/sdf.hpp>
 
 #include <freetype/freetype.h>
 
@@ -16,31 +21,88 @@
 #include <glm/gtc/type_ptr.hpp>
 
 struct Character {
-    GLuint texture;
+    // where the bitmap lives in the font's atlas
+    GlyphAtlas::Region region;
     Vector2D size;
     Vector2D bearing;
     long advance;
 };
 
 struct Font {
+    // kept open so glyphs can be rasterized the first time they show up
+    FT_Face face = nullptr;
     long ascent;
     long lineHeight;
-    std::map<char, Character> characters;
+    std::unique_ptr<GlyphAtlas> atlas;
+    std::unordered_map<char32_t, Character> characters;
+
+    // plain bitmaps until the distance fields come back from the background,
+    // after that `atlas` and `characters` hold sdf glyphs
+    bool sdf = false;
+    std::future<std::vector<sdf::Glyph>> pendingSdf;
+    // bumped whenever the atlas is swapped out
+    int generation = 0;
+};
+
+// a laid out run of text, ready to draw at any transform or color
+// holds its own vertex buffer, so redrawing it doesn't touch the glyphs again
+struct TextLayout {
+    Font* font = nullptr;
+    // what the uvs were worked out against
+    int fontGeneration = 0;
+    int atlasHeight = 0;
+
+    Vector2DF size;
+    // the box the glyph quads cover, in the same space as `vertices`
+    Vector2DF inkMin = { 0.f, 0.f };
+    Vector2DF inkMax = { 0.f, 0.f };
+    float maxCursorX = 0.f;
+    int lines = 1;
+
+    GLuint VAO = 0, VBO = 0;
+    int vertexCount = 0;
+    // the software backend draws straight from these instead of the buffer
+    std::vector<float> vertices;
+
+    TextLayout() = default;
+    ~TextLayout();
+
+    TextLayout(const TextLayout&) = delete;
+    TextLayout& operator=(const TextLayout&) = delete;
 };
 
 class TextRenderer {
 protected:
     FT_Library ft;
     std::unordered_map<std::string, Font> fonts;
-    GLuint textShaderProgram;
 
     static constexpr float LOAD_SIZE = 100.f;
 
-    GLuint VAO, VBO;
+    // reused between layouts, 6 vertices of (x, y, u, v) per glyph
+    std::vector<float> vertices;
+
+    // nullptr if the font couldn't be loaded
+    Font* getFont(const std::string& fontName);
+    // rasterizes and packs the glyph the first time it's asked for
+    const Character& getCharacter(Font& font, char32_t codepoint);
+    // swaps the font over to its distance field atlas once it's been generated
+    void pollSdf(Font& font);
 public:
     TextRenderer();
+    ~TextRenderer();
+
+    TextRenderer(const TextRenderer&) = delete;
+    TextRenderer& operator=(const TextRenderer&) = delete;
+
     void loadFont(std::string fontName);
 
+    // nullptr if the font couldn't be loaded
+    std::shared_ptr<TextLayout> layoutText(const std::string& text, const std::string& fontName, float pixelHeight);
+    // false once the font's atlas has changed under the layout and it needs building again
+    bool isCurrent(const TextLayout& layout);
+    Vector2DF drawLayout(Frame* frame, const TextLayout& layout, Transform transform, RGBAColor color);
+
+    // lays out and draws in one go, for one off text
     Vector2DF drawText(Frame* frame, std::string text, std::string fontName, Transform transform, RGBAColor color, float pixelHeight = 48.f);
     Vector2DF getTextSize(std::string text, std::string fontName, float scale = 1.f);
 };
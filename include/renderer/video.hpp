@@ -5,6 +5,7 @@ extern "C" {
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
 #include <libswscale/swscale.h>
+#include <libswresample/swresample.h>
 #include <libavutil/imgutils.h>
 }
 
@@ -13,6 +14,10 @@ extern "C" {
 #include <memory>
 
 #include <frame.hpp>
+#include <renderer/pipeline.hpp>
+#include <renderer/yuv.hpp>
+#include <renderer/settings.hpp>
+#include <renderer/audio.hpp>
 
 class VideoRenderer {
 protected:
@@ -22,21 +27,53 @@ protected:
     AVStream* audio_stream = nullptr;
     AVCodecContext* codec_ctx = nullptr;
     AVCodecContext* audio_codec_ctx = nullptr;
-    AVFrame* frame = nullptr;
-    SwsContext* sws_ctx = nullptr;
 
     int width;
     int height;
 
     int fps;
 
+    // frames submitted by the GL thread / frames sent to the encoder (encoder thread)
     int currentFrame = 0;
-    int audioCurrentFrame = 0;
+    int encodedFrames = 0;
 
     std::string filename;
+    ExportSettings settings;
+
+    // mixed audio is encoded alongside the video, on the encoder thread
+    std::shared_ptr<AudioRenderer> audio;
+    AVFrame* audioFrame = nullptr;
+    // only for encoders that take neither float layout, converts the interleaved mix
+    SwrContext* audioResampler = nullptr;
+    int audioFrameSize = 0;
+    int64_t audioSamples = 0;
+    std::vector<float> mixBuffer;
+
+    bool openAudio();
+    bool encodeAudioUntil(int64_t targetSample);
+
+    std::unique_ptr<ExportPipeline> pipeline;
+    PipelineStats stats;
+
+    // converts on the GPU when possible, otherwise RGBA is read back and converted on the workers
+    std::unique_ptr<YUVConverter> yuv;
+
+    // pipeline stages, see ExportPipeline for which thread runs what
+    bool convertRGBA(const uint8_t* data, AVFrame* out, ExportPipeline::ConvertContext& ctx);
+    bool convertI420(const uint8_t* data, AVFrame* out);
+    bool sendFrame(AVFrame* out);
+    bool writePackets(AVCodecContext* ctx, AVStream* st);
+
+    // false if the encoder could not be set up or a write failed
+    bool ok = false;
 public:
-    VideoRenderer(std::string filename, int width, int height, int fps);
+    // audio is optional, when given it's muxed into the same file
+    VideoRenderer(std::string filename, int width, int height, int fps, ExportSettings settings = {}, std::shared_ptr<AudioRenderer> audio = nullptr);
     void addFrame(std::shared_ptr<Frame> frame);
-    void addAudio(std::vector<float>& data);
-    void finish();
+    // returns false if anything went wrong during the export
+    bool finish();
+
+    bool isOk() const { return ok; }
+    // only filled in once finish() has run
+    const PipelineStats& getStats() const { return stats; }
 };
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glad/include/glad/gl.h>
+#include <SDL3/SDL_opengl.h>
+
+#include <shaders/shader.hpp>
+
+class Frame;
+class ReadbackRing;
+
+// converts a composited frame to YUV420P on the GPU so only the
+// planes (1.5 bytes per pixel) have to be read back for encoding
+class YUVConverter {
+protected:
+    int width;
+    int height;
+    int chromaWidth;
+    int chromaHeight;
+
+    GLuint yTexture = 0, uTexture = 0, vTexture = 0;
+    GLuint yFbo = 0, uvFbo = 0;
+
+    // shared, owned by the shader registry
+    shader::Program* yProgram = nullptr;
+    shader::Program* uvProgram = nullptr;
+    GLuint VAO = 0;
+
+    bool ok = false;
+
+    GLuint createPlane(int w, int h);
+public:
+    YUVConverter(int width, int height);
+    ~YUVConverter();
+
+    YUVConverter(const YUVConverter&) = delete;
+    YUVConverter& operator=(const YUVConverter&) = delete;
+
+    bool isOk() const { return ok; }
+
+    int getChromaWidth() const { return chromaWidth; }
+    int getChromaHeight() const { return chromaHeight; }
+
+    // size of one contiguous I420 frame (Y, then U, then V, no padding)
+    size_t getBufferSize() const;
+
+    // renders the frame's texture into the Y/U/V planes
+    void convert(Frame* frame);
+
+    // queues readback of the last converted planes into the ring
+    bool queue(ReadbackRing* ring, int frameNum);
+};
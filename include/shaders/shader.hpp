@@ -3,7 +3,34 @@
 #include <glad/include/glad/gl.h>
 #include <SDL3/SDL_opengl.h>
 
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
 namespace shader {
     GLuint compileShader(GLenum type, const char* source);
     GLuint createProgram(const char* vertex, const char* fragment);
+
+    // a linked program, with uniform locations looked up once and then cached
+    class Program {
+    protected:
+        struct NameHash {
+            using is_transparent = void;
+            size_t operator()(std::string_view name) const { return std::hash<std::string_view>()(name); }
+        };
+
+        GLuint id = 0;
+        std::unordered_map<std::string, GLint, NameHash, std::equal_to<>> uniforms;
+    public:
+        Program(GLuint id): id(id) {}
+
+        GLuint getID() const { return id; }
+        GLint uniform(std::string_view name);
+        void use() const { glUseProgram(id); }
+    };
+
+    // compiled and linked the first time a source pair is asked for, then shared by everyone
+    // (shader sources are inline globals, so their addresses are a stable key)
+    Program& getProgram(const char* vertex, const char* fragment);
 }
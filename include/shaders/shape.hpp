@@ -1,13 +1,21 @@
 #pragma once
 
+// positions come in already transformed (see QuadBatch), everything
+// that used to be a uniform is a vertex attribute so shapes can share a draw
 inline auto shapeVertex = R"(
 #version 330 core
-layout (location = 0) in vec3 aPos;
+layout (location = 0) in vec4 aPos;
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec4 aShape;
 
-uniform mat4 matrix;
+out vec4 color;
+// type, radius, center
+flat out vec4 shape;
 
 void main() {
-    gl_Position = matrix * vec4(aPos, 1.0);
+    gl_Position = aPos;
+    color = aColor;
+    shape = aShape;
 }   
 )";
 
@@ -15,23 +23,18 @@ inline auto shapeFragment = R"(
 #version 330 core
 out vec4 FragColor;
 
-uniform vec4 outColor;
-uniform mat4 matrix;
-
-// different types/circle stuff
-uniform int type;
-uniform float radius;
-uniform vec2 center;
+in vec4 color;
+flat in vec4 shape;
 
 void main() {
-    switch (type) {
+    switch (int(shape.x)) {
         case 1:    
-            if (sqrt(pow(gl_FragCoord.x - center.x, 2) + pow(gl_FragCoord.y - center.y, 2)) > radius)
+            if (distance(gl_FragCoord.xy, shape.zw) > shape.y)
                 discard;
             break;
         default: break;
     }
 
-    FragColor = outColor;
+    FragColor = color;
 } 
 )";
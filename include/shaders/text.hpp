@@ -22,9 +22,19 @@ out vec4 FragColor;
 
 uniform sampler2D text;
 uniform vec4 textColor;
+// 1 if the atlas holds distance fields instead of coverage
+uniform int sdf;
 
 void main() {
-    vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
+    float value = texture(text, TexCoords).r;
+    float alpha = value;
+    if (sdf == 1) {
+        // the outline sits at 0.5, antialias over about a screen pixel whatever the scale
+        float width = max(fwidth(value), 0.0001);
+        alpha = smoothstep(0.5 - width, 0.5 + width, value);
+    }
+
+    vec4 sampled = vec4(1.0, 1.0, 1.0, alpha);
     FragColor = textColor * sampled;
     // FragColor = vec4(0.0, 0.0, 0.0, 1.0);
 }
@@ -2,16 +2,17 @@
 
 inline auto textureVertex = R"(
 #version 330 core
-layout (location = 0) in vec3 aPos;
+layout (location = 0) in vec4 aPos;
 layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aColor;
 
 out vec2 TexCoord;
-
-uniform mat4 matrix;
+out float opacity;
 
 void main() {
-    gl_Position = matrix * vec4(aPos, 1.0);
+    gl_Position = aPos;
     TexCoord = aTexCoord;
+    opacity = aColor.a;
 }
 )";
 
@@ -20,9 +21,9 @@ inline auto textureFragment = R"(
 out vec4 FragColor;
 
 in vec2 TexCoord;
+in float opacity;
 
 uniform sampler2D texture1;
-uniform float opacity;
 
 void main() {
     FragColor = vec4(texture(texture1, TexCoord).xyz, opacity);
@@ -30,16 +31,31 @@ void main() {
 }
 )";
 
+// the texture is already premultiplied, so opacity scales every channel
+inline auto textureFragmentPremultiplied = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in float opacity;
+
+uniform sampler2D texture1;
+
+void main() {
+    FragColor = texture(texture1, TexCoord) * opacity;
+}
+)";
+
 inline auto textureFragmentYUV = R"(
 #version 330 core
 out vec4 FragColor;
 
 in vec2 TexCoord;
+in float opacity;
 
 uniform sampler2D textureY;
 uniform sampler2D textureU;
 uniform sampler2D textureV;
-uniform float opacity;
 
 void main() {
     float y = texture(textureY, TexCoord).r;
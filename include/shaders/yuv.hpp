@@ -0,0 +1,49 @@
+#pragma once
+
+// RGBA -> YUV420P (BT.601, limited range, same as swscale's default)
+// everything is drawn with a single fullscreen triangle, no vertex buffers needed
+
+inline auto yuvVertex = R"(
+#version 330 core
+
+void main() {
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+inline auto yuvFragmentY = R"(
+#version 330 core
+layout (location = 0) out float Y;
+
+uniform sampler2D source;
+
+void main() {
+    vec3 rgb = texelFetch(source, ivec2(gl_FragCoord.xy), 0).rgb;
+    Y = 0.0627451 + dot(rgb, vec3(0.256788, 0.504129, 0.0979059));
+}
+)";
+
+// one fragment per 2x2 block of the source, written to both chroma planes at once
+inline auto yuvFragmentUV = R"(
+#version 330 core
+layout (location = 0) out float U;
+layout (location = 1) out float V;
+
+uniform sampler2D source;
+
+void main() {
+    ivec2 maxPos = textureSize(source, 0) - 1;
+    ivec2 pos = ivec2(gl_FragCoord.xy) * 2;
+
+    vec3 rgb = (
+        texelFetch(source, min(pos, maxPos), 0).rgb +
+        texelFetch(source, min(pos + ivec2(1, 0), maxPos), 0).rgb +
+        texelFetch(source, min(pos + ivec2(0, 1), maxPos), 0).rgb +
+        texelFetch(source, min(pos + ivec2(1, 1), maxPos), 0).rgb
+    ) * 0.25;
+
+    U = 0.501961 + dot(rgb, vec3(-0.148223, -0.290993, 0.439216));
+    V = 0.501961 + dot(rgb, vec3(0.439216, -0.367788, -0.0714275));
+}
+)";
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+// a small integer id into a SlotMap. the generation changes every time a slot is
+// reused, so a handle to something that was removed resolves to nothing instead of
+// whatever took its place
+struct SlotHandle {
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    uint32_t index = INVALID;
+    uint32_t generation = 0;
+
+    bool valid() const { return index != INVALID; }
+    bool operator==(const SlotHandle&) const = default;
+};
+
+template <>
+struct std::hash<SlotHandle> {
+    size_t operator()(const SlotHandle& handle) const {
+        return ((size_t)handle.generation << 32) | handle.index;
+    }
+};
+
+// values in one vector, indexed straight by their handle. removed slots go on a
+// free list and get reused, so the vector only grows as far as the most ever alive
+template <typename T>
+class SlotMap {
+protected:
+    struct Slot {
+        uint32_t generation = 0;
+        std::optional<T> value;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    size_t count = 0;
+public:
+    SlotHandle insert(T value) {
+        uint32_t index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            index = slots.size();
+            slots.emplace_back();
+        }
+
+        auto& slot = slots[index];
+        slot.value = std::move(value);
+        count++;
+        return { index, slot.generation };
+    }
+
+    bool remove(SlotHandle handle) {
+        if (!get(handle)) return false;
+
+        auto& slot = slots[handle.index];
+        slot.value.reset();
+        slot.generation++;
+        freeSlots.push_back(handle.index);
+        count--;
+        return true;
+    }
+
+    // nullptr for invalid or stale handles
+    T* get(SlotHandle handle) {
+        if (handle.index >= slots.size()) return nullptr;
+
+        auto& slot = slots[handle.index];
+        if (slot.generation != handle.generation || !slot.value) return nullptr;
+        return &*slot.value;
+    }
+
+    const T* get(SlotHandle handle) const {
+        if (handle.index >= slots.size()) return nullptr;
+
+        auto& slot = slots[handle.index];
+        if (slot.generation != handle.generation || !slot.value) return nullptr;
+        return &*slot.value;
+    }
+
+    bool contains(SlotHandle handle) const { return get(handle) != nullptr; }
+    size_t size() const { return count; }
+};
@@ -2,7 +2,10 @@
 
 #include <video.hpp>
 #include <renderer/text.hpp>
+#include <renderer/settings.hpp>
+#include <renderer/preview.hpp>
 
+#include <atomic>
 #include <memory>
 #include <stack>
 
@@ -25,12 +28,18 @@ public:
 
     // std::shared_ptr<Clip> selectedClip = nullptr;
     // std::string selectedClipId = "";
-    std::vector<std::string> selectedClips;
+    std::vector<ClipHandle> selectedClips;
     int currentFrame = 0;
     int lastRenderedFrame = -1;
     bool isPlaying = false;
+    // set while Video::render runs, clips skip anything preview-only (like proxies)
+    // atomic since the clips' decode threads read it too
+    std::atomic<bool> isExporting = false;
 
     std::string exportPath;
+    ExportSettings exportSettings;
+
+    PreviewQuality previewQuality = PreviewQuality::Auto;
 
     ma_engine soundEngine;
 
@@ -62,45 +71,43 @@ public:
         selectedClips.clear();
     }
 
-    // deselects a specific ID
-    void deselect(std::string id) {
-        selectedClips.erase(
-            std::remove(selectedClips.begin(), selectedClips.end(), id),
-            selectedClips.end()
-        );
+    // deselects a specific clip
+    void deselect(ClipHandle handle) {
+        std::erase(selectedClips, handle);
     }
 
-    void selectClip(std::shared_ptr<Clip> clip) {
-        selectClip(clip->uID);
+    void deselect(std::shared_ptr<Clip> clip) {
+        deselect(clip->handle);
     }
-    
-    void selectClip(std::string id) {
-        if (isClipSelected(id)) return;
-        selectedClips.push_back(id);
-        for (auto selectedClipId : getSelectedClips()[id]->linkedClips) {
-            selectedClips.push_back(selectedClipId);
+
+    void selectClip(std::shared_ptr<Clip> clip) {
+        if (!clip->handle.valid() || isClipSelected(clip)) return;
+        selectedClips.push_back(clip->handle);
+        for (auto& linkedID : clip->linkedClips) {
+            auto linked = video->findClip(linkedID);
+            if (linked.valid() && !isClipSelected(linked)) {
+                selectedClips.push_back(linked);
+            }
         }
     }
 
-    std::unordered_map<std::string, std::shared_ptr<Clip>> getSelectedClips() {
-        if (selectedClips.empty()) return {};
-
-        std::unordered_map<std::string, std::shared_ptr<Clip>> result;
-        for (auto clipID : selectedClips) {
-            int trackIdx = video->getClipMap()[clipID];
-            std::shared_ptr<Clip> clip;
-            if (trackIdx < 0) {
-                clip = video->audioTracks[-(trackIdx + 1)]->getClip(clipID);
-            } else {
-                clip = video->videoTracks[trackIdx]->getClip(clipID);
+    // the selected clips that are still around, in the order they were selected
+    std::vector<std::shared_ptr<Clip>> getSelectedClips() {
+        std::vector<std::shared_ptr<Clip>> result;
+        result.reserve(selectedClips.size());
+        for (auto handle : selectedClips) {
+            if (auto clip = video->getClip(handle)) {
+                result.push_back(clip);
             }
-            result[clip->uID] = clip;
         }
         return result;
     }
 
     bool areClipsSelected() {
-        return !selectedClips.empty() && !getSelectedClips().empty();
+        for (auto handle : selectedClips) {
+            if (video->getClip(handle)) return true;
+        }
+        return false;
     }
 
     bool areClipsLinked() {
@@ -109,9 +116,9 @@ public:
 
         bool res = true;
         auto clips = getSelectedClips();
-        auto firstClip = clips.begin()->second;
+        auto firstClip = clips.front();
         if (firstClip->linkedClips.size() == 0) return false;
-        for (auto [_, clip] : clips) {
+        for (auto& clip : clips) {
             if (firstClip == clip) continue;
 
             if (firstClip->linkedClips != clip->linkedClips) {
@@ -122,11 +129,11 @@ public:
         return res;
     }
 
-    bool isClipSelected(std::string id) {
-        return std::find(selectedClips.begin(), selectedClips.end(), id) != selectedClips.end();
+    bool isClipSelected(ClipHandle handle) {
+        return std::find(selectedClips.begin(), selectedClips.end(), handle) != selectedClips.end();
     }
 
     bool isClipSelected(std::shared_ptr<Clip> clip) {
-        return isClipSelected(clip->uID);
+        return isClipSelected(clip->handle);
     }
 };
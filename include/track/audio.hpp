@@ -1,6 +1,9 @@
 #pragma once
 
 #include <clips/clip.hpp>
+#include <track/index.hpp>
+#include <algorithm>
+#include <span>
 #include <string>
 
 #include <miniaudio.h>
@@ -51,51 +54,51 @@ public:
 
 class AudioTrack {
 private:
-    std::unordered_map<std::string, std::shared_ptr<AudioClip>> clips;
+    // in the order they were added
+    std::vector<std::shared_ptr<AudioClip>> clips;
+    ClipIndex<AudioClip> index;
 public:
     AudioTrack() {
         clips = {};
     }
 
     void addClip(std::shared_ptr<AudioClip> clip) {
-        clips[clip->uID] = (clip);
-    }
-
-    std::shared_ptr<AudioClip> getClip(std::string id) {
-        if (!clips.contains(id)) return nullptr;
+        if (index.contains(clip.get())) return;
 
-        return clips[id];
+        clips.push_back(clip);
+        index.add(clip);
     }
 
-    void removeClip(std::shared_ptr<AudioClip> clip) {
-        std::erase_if(clips, [clip](const auto& _clip) {
-            return _clip.second == clip;
-        });
+    // call after changing a clip's startFrame / duration, see ClipIndex
+    void updateClip(std::shared_ptr<AudioClip> clip) {
+        index.update(clip);
     }
 
-    void removeClip(std::string clipID) {
-        if (!clips.at(clipID).get()) {
+    void removeClip(std::shared_ptr<AudioClip> clip) {
+        auto it = std::find(clips.begin(), clips.end(), clip);
+        if (it == clips.end()) {
             fmt::println("invalid pointer!");
             return;
         }
-        // std::erase_if(clips, [clipID](const auto& _clip) {
-        //     return _clip.second->uID == clipID;
-        // });
-        clips.erase(clipID);
+        clips.erase(it);
+        index.remove(clip.get());
     }
 
-    std::unordered_map<std::string, std::shared_ptr<AudioClip>> getClips() {
+    // a view into the track, don't add or remove clips while going through it
+    std::span<const std::shared_ptr<AudioClip>> getClips() const {
         return clips;
     }
 
+    // the frame the last clip ends on, 0 for an empty track
+    int getEndFrame() const { return index.endFrame(); }
+
     void processTime();
     void onPlay();
     void onStop();
 
     void write(qn::HeapByteWriter& writer) {
         writer.writeI16(clips.size());
-        for (auto _clip : clips) {
-            auto clip = _clip.second;
+        for (auto& clip : clips) {
             clip->write(writer);
         }
     }
@@ -105,7 +108,9 @@ public:
         for (int i = 0; i < size; i++) {
             auto clip = std::make_shared<AudioClip>();
             clip->read(reader);
-            addClip(clip);
+            clips.push_back(clip);
         }
+        // indexed in one go, adding them one at a time redoes the index for each
+        index.assign(clips);
     }
 };
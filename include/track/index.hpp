@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// a track's clips ordered by start frame (ties broken by when they were added), with a
+// max-end segment tree on top so the clips covering a frame are found without walking
+// the rest, and the track's end is the root of the tree
+//
+// clips don't tell anyone when their timing changes, so whoever moves or resizes one
+// has to call update() (Video::updateClip does it for you) or it stays where it was
+template <typename T>
+class ClipIndex {
+protected:
+    struct Entry {
+        int start;
+        // inclusive, start + duration
+        int end;
+        // insertion order, kept across updates so overlapping clips keep their layering
+        uint64_t order;
+        std::shared_ptr<T> clip;
+    };
+
+    struct Key {
+        int start;
+        uint64_t order;
+    };
+
+    // sorted by (start, order)
+    std::vector<Entry> entries;
+    // 1 based, leaves at [leaves, leaves + entries.size()), empty ones are INT_MIN
+    std::vector<int> maxEnd;
+    size_t leaves = 0;
+    // where each clip was filed, so it can be found again after its timing changed
+    std::unordered_map<const T*, Key> keys;
+    uint64_t nextOrder = 0;
+
+    static constexpr int NONE = std::numeric_limits<int>::min();
+
+    static bool before(const Entry& entry, const Key& key) {
+        if (entry.start != key.start) return entry.start < key.start;
+        return entry.order < key.order;
+    }
+
+    size_t find(const Key& key) const {
+        auto it = std::lower_bound(entries.begin(), entries.end(), key, before);
+        return it - entries.begin();
+    }
+
+    // sizes the tree for the entries (a power of two, so growing it one clip at a time
+    // only rebuilds every time the count doubles) and fills it in
+    void rebuild() {
+        leaves = 1;
+        while (leaves < entries.size()) leaves <<= 1;
+
+        maxEnd.assign(leaves * 2, NONE);
+        for (size_t i = 0; i < entries.size(); i++) {
+            maxEnd[leaves + i] = entries[i].end;
+        }
+        for (size_t i = leaves - 1; i >= 1; i--) {
+            maxEnd[i] = std::max(maxEnd[i * 2], maxEnd[i * 2 + 1]);
+        }
+    }
+
+    // redoes the leaves in [from, to) and the nodes above them, everything else kept its place
+    void refresh(size_t from, size_t to) {
+        if (entries.size() > leaves) {
+            rebuild();
+            return;
+        }
+        if (from >= to) return;
+
+        for (size_t i = from; i < to; i++) {
+            maxEnd[leaves + i] = i < entries.size() ? entries[i].end : NONE;
+        }
+        for (size_t lo = (leaves + from) / 2, hi = (leaves + to - 1) / 2; lo >= 1; lo /= 2, hi /= 2) {
+            for (size_t node = lo; node <= hi; node++) {
+                maxEnd[node] = std::max(maxEnd[node * 2], maxEnd[node * 2 + 1]);
+            }
+        }
+    }
+
+    void setLeaf(size_t idx, int end) {
+        size_t node = leaves + idx;
+        maxEnd[node] = end;
+        for (node /= 2; node >= 1; node /= 2) {
+            maxEnd[node] = std::max(maxEnd[node * 2], maxEnd[node * 2 + 1]);
+        }
+    }
+
+    // returns where it went, the tree is left for the caller to refresh
+    size_t insert(std::shared_ptr<T> clip, uint64_t order) {
+        Key key = { clip->startFrame, order };
+        size_t idx = find(key);
+        entries.insert(entries.begin() + idx, { key.start, clip->startFrame + clip->duration, order, clip });
+        keys[clip.get()] = key;
+        return idx;
+    }
+
+    template <typename Fn>
+    void collect(size_t node, size_t lo, size_t hi, size_t limit, int frame, Fn& fn) const {
+        if (lo >= limit || maxEnd[node] < frame) return;
+        if (hi - lo == 1) {
+            fn(entries[lo].clip);
+            return;
+        }
+
+        size_t mid = (lo + hi) / 2;
+        collect(node * 2, lo, mid, limit, frame, fn);
+        collect(node * 2 + 1, mid, hi, limit, frame, fn);
+    }
+public:
+    // a clip added again goes back on top
+    void add(std::shared_ptr<T> clip) {
+        remove(clip.get());
+        // everything after it moved over by one
+        size_t idx = insert(clip, nextOrder++);
+        refresh(idx, entries.size());
+    }
+
+    // replaces the whole index with `clips`, layered in the order given. sorts and
+    // builds the tree once instead of once per clip, for loading a track
+    void assign(std::span<const std::shared_ptr<T>> clips) {
+        entries.clear();
+        keys.clear();
+        for (auto& clip : clips) {
+            if (keys.contains(clip.get())) continue;
+
+            Key key = { clip->startFrame, nextOrder++ };
+            entries.push_back({ key.start, clip->startFrame + clip->duration, key.order, clip });
+            keys[clip.get()] = key;
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return before(a, { b.start, b.order });
+        });
+        rebuild();
+    }
+
+    void remove(const T* clip) {
+        auto it = keys.find(clip);
+        if (it == keys.end()) return;
+
+        size_t idx = find(it->second);
+        keys.erase(it);
+        if (idx >= entries.size() || entries[idx].clip.get() != clip) return;
+
+        // everything after it moved back by one, and the old last leaf is empty now
+        entries.erase(entries.begin() + idx);
+        refresh(idx, entries.size() + 1);
+    }
+
+    // refiles a clip after its startFrame / duration changed
+    void update(std::shared_ptr<T> clip) {
+        auto it = keys.find(clip.get());
+        if (it == keys.end()) return;
+
+        Key key = it->second;
+        size_t idx = find(key);
+        if (idx >= entries.size() || entries[idx].clip != clip) return;
+
+        // only the end moved, the order is the same
+        if (key.start == clip->startFrame) {
+            entries[idx].end = clip->startFrame + clip->duration;
+            setLeaf(idx, entries[idx].end);
+            return;
+        }
+
+        entries.erase(entries.begin() + idx);
+        size_t moved = insert(clip, key.order);
+        // only the entries between where it was and where it went shifted
+        refresh(std::min(idx, moved), std::max(idx, moved) + 1);
+    }
+
+    // calls fn(clip) for every clip with start <= frame <= end, in layering order
+    template <typename Fn>
+    void forEachAt(int frame, Fn&& fn) const {
+        if (entries.empty()) return;
+
+        auto limit = std::upper_bound(entries.begin(), entries.end(), frame, [](int frame, const Entry& entry) {
+            return frame < entry.start;
+        }) - entries.begin();
+        collect(1, 0, leaves, limit, frame, fn);
+    }
+
+    // where the last clip ends, 0 if there are none
+    int endFrame() const {
+        if (entries.empty()) return 0;
+        return std::max(maxEnd[1], 0);
+    }
+
+    bool contains(const T* clip) const { return keys.contains(clip); }
+    size_t size() const { return entries.size(); }
+};
@@ -1,14 +1,42 @@
 #pragma once
 
-#include <unordered_map>
+#include <algorithm>
 #include <memory>
+#include <span>
 
 #include <clips/all.hpp>
+#include <track/index.hpp>
 
 class VideoTrack {
 private:
-    std::unordered_map<std::string, std::shared_ptr<Clip>> clips = {};
+    // in the order they were added
+    std::vector<std::shared_ptr<Clip>> clips = {};
+    // what render looks clips up by, also decides the order they're drawn in
+    ClipIndex<Clip> index;
     std::string uID;
+
+    // what this track drew last, transparent where there's nothing, premultiplied
+    std::shared_ptr<Frame> layer;
+    // hash of the clips and evaluated properties that went into `layer`
+    size_t layerHash = 0;
+    bool layerValid = false;
+
+    // on screen as of the last prepare, their static caches go once they leave
+    std::vector<std::shared_ptr<Clip>> lastActive;
+
+    struct ActiveClip {
+        std::shared_ptr<Clip> clip;
+        // everything that decides what the clip draws, except its opacity
+        size_t hash;
+        // Clip::isTimeInvariant as of prepare
+        bool invariant;
+    };
+
+    // evaluates keyframes and fades at `targetFrame`, returns the clips on screen
+    // and hashes everything that decides what they draw into `hash`
+    std::vector<ActiveClip> prepare(int targetFrame, size_t& hash);
+    // time invariant clips are drawn once into their static cache and blitted from then on
+    void drawClip(const ActiveClip& active, Frame* target);
 public:
     VideoTrack() {
         uID = utils::generateUUID();
@@ -18,37 +46,47 @@ public:
     VideoTrack& operator=(VideoTrack const&) = delete;
 
     void addClip(std::shared_ptr<Clip> clip) {
-        clips[clip->uID] = clip;
+        if (index.contains(clip.get())) return;
+
+        clips.push_back(clip);
+        index.add(clip);
         fmt::println("added clip with id {}", clip->uID);
     }
 
-    std::shared_ptr<Clip> getClip(std::string id) {
-        if (!clips.contains(id)) return nullptr;
-
-        return clips[id];
+    // call after changing a clip's startFrame / duration, see ClipIndex
+    void updateClip(std::shared_ptr<Clip> clip) {
+        index.update(clip);
     }
 
     void removeClip(std::shared_ptr<Clip> clip) {
-        std::erase_if(clips, [clip](const auto& _clip) {
-            return _clip.second->uID == clip->uID;
-        });
-    }
+        auto it = std::find(clips.begin(), clips.end(), clip);
+        if (it == clips.end()) return;
 
-    void removeClip(std::string clipID) {
-        std::erase_if(this->clips, [clipID](const auto& _clip) {
-            return _clip.second->uID == clipID;
-        });
+        clip->releaseStaticCache();
+        clip->onInactive();
+        std::erase(lastActive, clip);
+        index.remove(clip.get());
+        clips.erase(it);
     }
 
-    std::unordered_map<std::string, std::shared_ptr<Clip>> getClips() {
+    // a view into the track, don't add or remove clips while going through it
+    std::span<const std::shared_ptr<Clip>> getClips() const {
         return clips;
     }
 
+    // the frame the last clip ends on, 0 for an empty track
+    int getEndFrame() const { return index.endFrame(); }
+
     void render(Frame* frame, int currentFrame);
+    // renders into the track's own layer (sized like `target`), skipped if nothing changed
+    // since last time. nullptr if there is nothing on the track at `currentFrame`
+    Frame* renderLayer(int currentFrame, Frame* target);
+    // forces the next renderLayer to redraw
+    void invalidateLayer() { layerValid = false; }
 
     void write(qn::HeapByteWriter& writer) {
         writer.writeI16(clips.size());
-        for (auto [idx, clip] : clips) {
+        for (auto& clip : clips) {
             clip->write(writer);
         }
     }
@@ -91,7 +129,9 @@ public:
 
             clip->read(reader);
             fmt::println("{}", clip->m_metadata.name);
-            addClip(clip);
+            clips.push_back(clip);
         }
+        // indexed in one go, adding them one at a time redoes the index for each
+        index.assign(clips);
     }
 };
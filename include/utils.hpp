@@ -3,6 +3,9 @@
 #include <common.hpp>
 #include <frame.hpp>
 
+#include <string_view>
+#include <type_traits>
+
 // i roll my OWN pi
 #define PI 3.14159265358927
 
@@ -50,14 +53,24 @@ namespace utils {
     inline float interpolate(float progress, float a, float b) {
         return a + (b - a) * progress;
     }
+
+    // mixes `value` into `seed`, order matters
+    inline void hashCombine(size_t& seed, size_t value) {
+        seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+
+    // anything that isn't a string is hashed by its bytes, so keep padded structs away from this
+    template <typename T>
+    size_t hashValue(const T& value) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return std::hash<std::string>()(value);
+        } else {
+            static_assert(std::is_trivially_copyable_v<T>);
+            return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(&value), sizeof(T)));
+        }
+    }
 } // namespace utils
 
 namespace utils::video {
-    // these arent the best argument names
-    // but i like the album and the song
-    // so we're sticking with it
-    // (audio = audio input file, video = video input file, disco = overall output)
-    void combineAV(std::string audio, std::string video, std::string disco);
-
     void extractAudio(std::string filename);
 } // namespace video
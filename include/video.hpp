@@ -8,6 +8,7 @@
 #include <binary/writer.hpp>
 
 #include <common.hpp>
+#include <slotmap.hpp>
 #include <track/audio.hpp>
 #include <track/video.hpp>
 
@@ -33,10 +34,21 @@ struct ExtClipMetadata {
 
 class Video {
 protected:
-    // map of all clip IDs to their respective track indexes
-    // positive idx = video track
-    // negative idx = audio track
-    std::unordered_map<std::string, int> clipMap;
+    struct ClipSlot {
+        std::shared_ptr<Clip> clip;
+        // positive idx = video track
+        // negative idx = audio track, -(idx + 1)
+        int track;
+    };
+
+    // every clip in the video, by handle
+    SlotMap<ClipSlot> clipSlots;
+    // only for following linkedClips
+    std::unordered_map<std::string, ClipHandle> handlesByID;
+
+    // hands the clip a handle, or moves it to `track` if it already has one
+    void registerClip(std::shared_ptr<Clip> clip, int track);
+    void unregisterClip(std::shared_ptr<Clip> clip);
 public:
     int framerate;
 
@@ -65,12 +77,23 @@ public:
 
     void removeClip(int trackIdx, std::shared_ptr<Clip> clip);
     void removeAudioClip(int trackIdx, std::shared_ptr<AudioClip> clip);
+    // moves a clip to another track of the same kind, it keeps its handle
+    void changeClipTrack(std::shared_ptr<Clip> clip, int targetTrack);
+    // refiles a clip in its track after its startFrame / duration changed
+    void updateClip(std::shared_ptr<Clip> clip);
+
+    // nullptr for handles of clips that have been removed
+    std::shared_ptr<Clip> getClip(ClipHandle handle) const;
+    // positive for video tracks, -(idx + 1) for audio ones, 0 if the handle is stale
+    int getClipTrack(ClipHandle handle) const;
+    // invalid if no clip in the video has that uID
+    ClipHandle findClip(const std::string& uID) const;
 
     const std::vector<std::shared_ptr<VideoTrack>>& getTracks() const { return videoTracks; }
-    std::unordered_map<std::string, int> getClipMap() { return clipMap; }
 
     void render(VideoRenderer* renderer);
-    Frame* renderAtFrame(int frame);
+    // the frame is leased from FramePool, it goes back once the caller lets go of it
+    std::shared_ptr<Frame> renderAtFrame(int frame);
     void renderIntoFrame(int frameNum, std::shared_ptr<Frame> frame);
 
     int getFPS() { return framerate; }
@@ -109,6 +132,9 @@ public:
         }
     }
 
+    // loads a saved project, returns nullptr if the file can't be opened
+    static std::shared_ptr<Video> fromFile(const std::string& path);
+
     void read(qn::ByteReader& reader) {
         framerate = reader.readI16().unwrapOr(0);
         resolution.read(reader);
@@ -117,6 +143,9 @@ public:
         for (int i = 0; i < vidSize; i++) {
             auto track = std::make_shared<VideoTrack>();
             track->read(reader);
+            for (auto& clip : track->getClips()) {
+                registerClip(clip, i);
+            }
             videoTracks.push_back(track);
         }
 
@@ -124,6 +153,9 @@ public:
         for (int i = 0; i < audSize; i++) {
             auto track = std::make_shared<AudioTrack>();
             track->read(reader);
+            for (auto& clip : track->getClips()) {
+                registerClip(clip, -(i + 1));
+            }
             audioTracks.push_back(track);
         }
 
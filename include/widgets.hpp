@@ -56,7 +56,7 @@ protected:
         In,
         Out
     } fadeDragMode;
-    std::string fadeAdjustID;
+    ClipHandle fadeAdjustClip;
     bool isScrubbing;
 
     bool isMovingBetweenTracks;
@@ -135,8 +135,8 @@ public:
 
     void render();
 
-    bool willClipCollide(int frame, int duration, int trackIdx, TrackType type, std::vector<std::string> exclusionList = {});
-    bool willClipCollide(float seconds, float duration, int trackIdx, TrackType type, std::vector<std::string> exclusionList = {});
+    bool willClipCollide(int frame, int duration, int trackIdx, TrackType type, std::vector<ClipHandle> exclusionList = {});
+    bool willClipCollide(float seconds, float duration, int trackIdx, TrackType type, std::vector<ClipHandle> exclusionList = {});
 };
 
 // https://github.com/ocornut/imgui/issues/1901
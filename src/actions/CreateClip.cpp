@@ -21,7 +21,7 @@ void CreateClip::perform() {
 void CreateClip::undo() {
     auto& state = State::get();
 
-    state.deselect(clip->uID);
+    state.deselect(clip);
 
     switch (type) {
         case ClipType::Audio:
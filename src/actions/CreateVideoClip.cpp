@@ -8,12 +8,12 @@
 void CreateVideoClip::perform() {
     auto& state = State::get();
     state.deselect();
-    auto videoClip = std::make_shared<clips::VideoClip>(metadata.filePath);
+    videoClip = std::make_shared<clips::VideoClip>(metadata.filePath);
     
     videoClip->startFrame = frame;
     videoClip->duration = metadata.frameCount;
 
-    auto audioClip = std::make_shared<AudioClip>(fmt::format("{}.mp3", metadata.filePath));
+    audioClip = std::make_shared<AudioClip>(fmt::format("{}.mp3", metadata.filePath));
 
     audioClip->startFrame = frame;
     audioClip->duration = metadata.frameCount;
@@ -26,9 +26,6 @@ void CreateVideoClip::perform() {
     state.video->addClip(trackIdx, videoClip);
     state.video->addAudioClip(trackIdx, audioClip);
 
-    videoUID = videoClip->uID;
-    audioUID = audioClip->uID;
-
     state.selectClip(videoClip);
 
     state.lastRenderedFrame = -1;
@@ -37,9 +34,9 @@ void CreateVideoClip::perform() {
 void CreateVideoClip::undo() {
     auto& state = State::get();
 
-    state.deselect(videoUID);
-    state.deselect(audioUID);
+    state.deselect(videoClip);
+    state.deselect(audioClip);
 
-    state.video->removeClip(trackIdx, state.video->videoTracks[trackIdx]->getClip(videoUID));
-    state.video->removeAudioClip(trackIdx, state.video->audioTracks[trackIdx]->getClip(audioUID));
+    state.video->removeClip(trackIdx, videoClip);
+    state.video->removeAudioClip(trackIdx, audioClip);
 }
@@ -8,6 +8,7 @@ void ResizeClip::perform() {
     
     clip->startFrame = newStartFrame;
     clip->duration = newDuration;
+    state.video->updateClip(clip);
 }
 
 void ResizeClip::undo() {
@@ -15,4 +16,5 @@ void ResizeClip::undo() {
 
     clip->startFrame = initialStartFrame;
     clip->duration = initialDuration;
+    state.video->updateClip(clip);
 }
@@ -0,0 +1,89 @@
+#include <cache/frame.hpp>
+
+FrameCache& FrameCache::get() {
+    static FrameCache instance;
+    return instance;
+}
+
+FrameCache::Entry FrameCache::find(const std::string& path, int frame) {
+    std::lock_guard lock(mutex);
+
+    auto it = lookup.find({ path, frame });
+    if (it == lookup.end()) {
+        misses++;
+        return nullptr;
+    }
+
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->second;
+}
+
+void FrameCache::insert(const std::string& path, int frame, Entry decoded) {
+    if (!decoded) return;
+
+    std::lock_guard lock(mutex);
+
+    Key key { path, frame };
+    if (auto it = lookup.find(key); it != lookup.end()) {
+        usage -= it->second->second->data.size();
+        entries.erase(it->second);
+        lookup.erase(it);
+    }
+
+    usage += decoded->data.size();
+    entries.emplace_front(key, std::move(decoded));
+    lookup[key] = entries.begin();
+
+    evict();
+}
+
+void FrameCache::evict() {
+    // always keep the newest one, even if it's bigger than the whole budget
+    while (usage > budget && entries.size() > 1) {
+        auto& [key, entry] = entries.back();
+        usage -= entry->data.size();
+        lookup.erase(key);
+        entries.pop_back();
+    }
+}
+
+void FrameCache::setBudget(size_t bytes) {
+    std::lock_guard lock(mutex);
+    budget = bytes;
+    evict();
+}
+
+void FrameCache::clear() {
+    std::lock_guard lock(mutex);
+    entries.clear();
+    lookup.clear();
+    usage = 0;
+    hits = 0;
+    misses = 0;
+}
+
+size_t FrameCache::getBudget() const {
+    std::lock_guard lock(mutex);
+    return budget;
+}
+
+size_t FrameCache::getUsage() const {
+    std::lock_guard lock(mutex);
+    return usage;
+}
+
+size_t FrameCache::getHits() const {
+    std::lock_guard lock(mutex);
+    return hits;
+}
+
+size_t FrameCache::getMisses() const {
+    std::lock_guard lock(mutex);
+    return misses;
+}
+
+size_t FrameCache::getCount() const {
+    std::lock_guard lock(mutex);
+    return entries.size();
+}
@@ -0,0 +1,285 @@
+// paperclip-render
+// headless exporter for rendering saved projects without the editor UI
+//
+// usage: paperclip-render [options] <project.pclp> <output.mp4> [<project.pclp> <output.mp4> ...]
+//
+// options (applied to every export):
+//   --codec h264|hevc|vp9|av1|prores
+//   --preset ultrafast|superfast|veryfast|faster|fast|medium|slow|slower|veryslow
+//   --crf <n>             constant quality (default)
+//   --bitrate <kbps>      target bitrate instead of crf
+//   --threads <n>         encoder threads, 0 = auto
+//   --thread-type auto|frame|slice
+//   --gop <n>             keyframe interval
+//   --backend opengl|software
+//                         software renders on the cpu and doesn't need a GL context at all
+//
+// every project/output pair is rendered in order using one GL context (or none).
+// exit codes:
+//   0 - every export succeeded
+//   1 - bad arguments
+//   2 - could not initialize SDL / OpenGL / mlt / audio
+//   3 - at least one project failed to load or export
+
+#include <video.hpp>
+#include <state.hpp>
+#include <renderer/text.hpp>
+#include <renderer/backend.hpp>
+#include <renderer/export.hpp>
+#include <renderer/software.hpp>
+
+#include <SDL3/SDL.h>
+#include <glad/include/glad/gl.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <fmt/base.h>
+#include <fmt/format.h>
+#include <miniaudio.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+enum ExitCode {
+    EXIT_OK = 0,
+    EXIT_USAGE = 1,
+    EXIT_INIT_FAILED = 2,
+    EXIT_RENDER_FAILED = 3
+};
+
+struct RenderJob {
+    std::string project;
+    std::string output;
+};
+
+struct HeadlessContext {
+    SDL_Window* window = nullptr;
+    SDL_GLContext glContext = nullptr;
+
+    bool init() {
+        // no display on render machines, so go through EGL
+        // (surfaceless / llvmpipe on mesa). setting SDL_VIDEO_DRIVER overrides this
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+
+        if (!SDL_Init(SDL_INIT_VIDEO)) {
+            fmt::println("SDL Init error: {}", SDL_GetError());
+            return false;
+        }
+
+        SDL_SetAppMetadata("paperclip-render", "1.0", "com.underscored.paperclip");
+
+        // all of our shaders are #version 330 core, which llvmpipe handles fine
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+        SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 8);
+
+        // everything renders into Frame FBOs, the window only exists to own the context
+        window = SDL_CreateWindow("paperclip-render", 1, 1, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+        if (!window) {
+            fmt::println("could not create window: {}", SDL_GetError());
+            return false;
+        }
+
+        glContext = SDL_GL_CreateContext(window);
+        if (!glContext) {
+            fmt::println("could not create GL context: {}", SDL_GetError());
+            return false;
+        }
+        SDL_GL_MakeCurrent(window, glContext);
+
+        int version = gladLoadGL((GLADloadfunc)&SDL_GL_GetProcAddress);
+        if (version == 0) {
+            fmt::println("could NOT initalize GLAD");
+            return false;
+        }
+        fmt::println("GL Version: {}", (const char*)glGetString(GL_VERSION));
+        fmt::println("GL Renderer: {}", (const char*)glGetString(GL_RENDERER));
+
+        return true;
+    }
+
+    ~HeadlessContext() {
+        if (glContext) SDL_GL_DestroyContext(glContext);
+        if (window) SDL_DestroyWindow(window);
+        SDL_Quit();
+    }
+};
+
+static bool parseInt(const std::string& value, int& out) {
+    try {
+        size_t used = 0;
+        out = std::stoi(value, &used);
+        return used == value.size();
+    } catch (...) {
+        return false;
+    }
+}
+
+// returns false (after printing why) on bad arguments
+static bool parseArgs(int argc, char** argv, ExportSettings& settings, RenderBackend& renderBackend, std::vector<std::string>& paths) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (!arg.starts_with("--")) {
+            paths.push_back(arg);
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            fmt::println("missing value for {}", arg);
+            return false;
+        }
+        std::string value = argv[++i];
+
+        bool valid = true;
+        if (arg == "--codec") {
+            valid = ExportSettings::parseCodec(value, settings.codec);
+        } else if (arg == "--preset") {
+            valid = ExportSettings::parsePreset(value, settings.preset);
+        } else if (arg == "--crf") {
+            settings.rateControl = RateControl::CRF;
+            valid = parseInt(value, settings.crf) && settings.crf >= 0;
+        } else if (arg == "--bitrate") {
+            settings.rateControl = RateControl::Bitrate;
+            valid = parseInt(value, settings.bitrate) && settings.bitrate > 0;
+        } else if (arg == "--threads") {
+            valid = parseInt(value, settings.threads) && settings.threads >= 0;
+        } else if (arg == "--thread-type") {
+            valid = ExportSettings::parseThreading(value, settings.threading);
+        } else if (arg == "--gop") {
+            valid = parseInt(value, settings.keyframeInterval) && settings.keyframeInterval > 0;
+        } else if (arg == "--backend") {
+            valid = backend::parse(value, renderBackend);
+        } else {
+            fmt::println("unknown option {}", arg);
+            return false;
+        }
+
+        if (!valid) {
+            fmt::println("invalid value for {}: {}", arg, value);
+            return false;
+        }
+    }
+
+    if (paths.empty() || paths.size() % 2 != 0) {
+        fmt::println("expected pairs of <project.pclp> <output>");
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+    ExportSettings settings;
+    RenderBackend renderBackend = RenderBackend::OpenGL;
+    std::vector<std::string> paths;
+    if (!parseArgs(argc, argv, settings, renderBackend, paths)) {
+        fmt::println("usage: {} [options] <project.pclp> <output.mp4> [<project.pclp> <output.mp4> ...]", argv[0]);
+        return EXIT_USAGE;
+    }
+
+    // resources are looked up relative to the working directory,
+    // so resolve the jobs before moving next to the executable
+    std::vector<RenderJob> jobs;
+    for (size_t i = 0; i + 1 < paths.size(); i += 2) {
+        jobs.push_back({
+            .project = std::filesystem::absolute(paths[i]).string(),
+            .output = std::filesystem::absolute(paths[i + 1]).string()
+        });
+    }
+
+    if (auto basePath = SDL_GetBasePath()) {
+        std::error_code ec;
+        std::filesystem::current_path(basePath, ec);
+    }
+
+    if (mlt_factory_init("resources/mlt") == 0) {
+        fmt::println("unable to init mlt factory");
+        return EXIT_INIT_FAILED;
+    }
+
+    // has to be picked before the first Frame or texture is made
+    backend::set(renderBackend);
+
+    HeadlessContext context;
+    if (renderBackend == RenderBackend::OpenGL && !context.init()) {
+        mlt_factory_close();
+        return EXIT_INIT_FAILED;
+    }
+    if (renderBackend == RenderBackend::Software) {
+        fmt::println("Software renderer: {} threads", SoftwareRasterizer::get().getThreadCount());
+    }
+
+    auto& state = State::get();
+
+    // audio clips still need an engine to load, but nothing is played back
+    ma_engine_config engineConfig = ma_engine_config_init();
+    engineConfig.noDevice = MA_TRUE;
+    engineConfig.channels = 2;
+    engineConfig.sampleRate = 48000;
+    if (ma_engine_init(&engineConfig, &state.soundEngine) != MA_SUCCESS) {
+        fmt::println("could not init engine");
+        mlt_factory_close();
+        return EXIT_INIT_FAILED;
+    }
+
+    state.textRenderer = std::make_shared<TextRenderer>();
+
+    int failed = 0;
+    int totalFrames = 0;
+    double totalSeconds = 0.0;
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+        auto& job = jobs[i];
+        fmt::println("[{}/{}] {} -> {}", i + 1, jobs.size(), job.project, job.output);
+
+        auto video = Video::fromFile(job.project);
+        if (!video) {
+            failed++;
+            continue;
+        }
+        state.video = video;
+
+        Exporter exporter(video, job.output, settings);
+        bool success = exporter.run();
+        auto& stats = exporter.getStats();
+
+        totalFrames += stats.frames;
+        totalSeconds += stats.totalSeconds;
+
+        if (!success) {
+            failed++;
+            continue;
+        }
+
+        fmt::println(
+            "[{}/{}] {} frames in {:.2f}s ({:.1f} fps render, {:.2f}s total)",
+            i + 1, jobs.size(), stats.frames, stats.videoSeconds, stats.fps(), stats.totalSeconds
+        );
+
+        auto& pipeline = stats.pipeline;
+        fmt::println(
+            "    render {:.2f}s, readback {:.2f}s, convert {:.2f}s (all workers), encode {:.2f}s",
+            pipeline.renderSeconds, pipeline.readbackSeconds, pipeline.convertSeconds, pipeline.encodeSeconds
+        );
+        fmt::println(
+            "    stalls: gpu {}, convert {}, encode {}, encoder idle {}",
+            pipeline.readbackWaits, pipeline.convertStalls, pipeline.encodeStalls, pipeline.encoderStarved
+        );
+    }
+
+    fmt::println(
+        "done: {}/{} succeeded, {} frames in {:.2f}s ({:.1f} fps overall)",
+        jobs.size() - failed, jobs.size(), totalFrames, totalSeconds,
+        totalSeconds > 0.0 ? totalFrames / totalSeconds : 0.0
+    );
+
+    state.video = nullptr;
+    state.textRenderer = nullptr;
+    ma_engine_uninit(&state.soundEngine);
+    mlt_factory_close();
+
+    return failed == 0 ? EXIT_OK : EXIT_RENDER_FAILED;
+}
@@ -62,7 +62,7 @@ namespace clips {
     }
 
     GLuint Circle::getPreviewTexture(int frameIdx) {
-        return frame->textureID;
+        return frame->getTexture();
     }
 
     Vector2D Circle::getPreviewSize() { return { 600, 600 }; }
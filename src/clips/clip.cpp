@@ -20,58 +20,146 @@ void Clip::dispatchChange() {
     }
 }
 
-void ClipPropertyBase::processKeyframe(int targetFrame) {
-    auto keyframes = getKeyframes();
-    fmt::println("currently processing property {}", id);
-    if (debug(keyframes.size()) == 1) {
-        fmt::println("only one keyframe; using it");
-        updateData(1, keyframes[0], keyframes[0]);
-        return;
+bool Clip::isTimeInvariant() {
+    if (!hasStaticContent()) return false;
+
+    for (auto& [id, property] : m_properties) {
+        if (property->getKeyframeCount() > 1) return false;
     }
+    return true;
+}
 
-    // beyond the last keyframe? use that
-    if (keyframes[keyframes.size() - 1] <= targetFrame - clip->startFrame) {
-        fmt::println("beyond last keyframe; using it");
-        updateData(1, keyframes[keyframes.size() - 1], keyframes[keyframes.size() - 1]);
-        return;
+uint64_t Clip::getKeyframeVersions() {
+    uint64_t versions = 0;
+    for (auto& [id, property] : m_properties) {
+        versions += property->getKeyframeVersion();
     }
+    return versions;
+}
 
-    int previousKeyframe = 0;
-    int nextKeyframe = 0;
+void ClipPropertyBase::compileKeyframes() {
+    auto& frames = getKeyframes();
 
-    for (auto keyframe : keyframes) {
-        if (keyframe > targetFrame - clip->startFrame) {
-            nextKeyframe = keyframe;
-            break;
+    easings.resize(frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        int info = keyframeInfo.indexOf(frames[i]);
+        if (info < 0) {
+            easings[i] = animation::easing::linear;
+            continue;
         }
 
-        if (keyframe > previousKeyframe) {
-            previousKeyframe = keyframe;
-        }
+        auto& meta = keyframeInfo.valueAt(info);
+        easings[i] = animation::getEasingFunction(meta.easing, meta.mode);
+    }
+
+    compiledVersion = getKeyframeVersion();
+    compiledInfoVersion = keyframeInfo.getVersion();
+    cursor = 0;
+}
+
+size_t ClipPropertyBase::findSegment(const std::vector<int>& frames, int frame) {
+    // still in the same segment, or just moved into the next one
+    if (cursor + 1 < frames.size() && frames[cursor] <= frame) {
+        if (frame < frames[cursor + 1]) return cursor;
+        if (cursor + 2 < frames.size() && frame < frames[cursor + 2]) return ++cursor;
+    }
+
+    cursor = std::upper_bound(frames.begin(), frames.end(), frame) - frames.begin() - 1;
+    return cursor;
+}
+
+void ClipPropertyBase::prepareEvaluation() {
+    if (compiledVersion != getKeyframeVersion() || compiledInfoVersion != keyframeInfo.getVersion()) {
+        compileKeyframes();
+    }
+}
+
+void ClipPropertyBase::processKeyframe(int targetFrame) {
+    if (samples && samples->covers(targetFrame)) {
+        size_t idx = targetFrame - samples->startFrame;
+        updateData(samples->progress[idx], samples->previous[idx], samples->next[idx]);
+        return;
     }
 
-    if (nextKeyframe == 0) {
-        // somehow we did not catch the last keyframe, so we just set it here
-        fmt::println("did not catch that we are beyond the last keyframe; using it");
-        updateData(1, previousKeyframe, previousKeyframe);
+    prepareEvaluation();
+
+    auto& frames = getKeyframes();
+    if (frames.empty()) return;
+
+    int frame = targetFrame - clip->startFrame;
+
+    // before the first or beyond the last keyframe? hold it
+    if (frame < frames.front()) {
+        updateData(1, 0, 0);
         return;
     }
+    if (frame >= frames.back()) {
+        int last = frames.size() - 1;
+        updateData(1, last, last);
+        return;
+    }
+
+    size_t previous = findSegment(frames, frame);
+    size_t next = previous + 1;
+
+    float progress = (float)(frame - frames[previous]) / (float)(frames[next] - frames[previous]);
+    progress = easings[next](progress);
 
-    float progress = (float)(targetFrame - clip->startFrame - previousKeyframe) / (float)(nextKeyframe - previousKeyframe);
-    if (keyframeInfo.contains(nextKeyframe)) {
-        progress = animation::getEasingFunction(keyframeInfo[nextKeyframe].easing, keyframeInfo[nextKeyframe].mode)(progress);
+    updateData(progress, previous, next);
+}
+
+void ClipPropertyBase::evaluateRange(int startFrame, int count, KeyframeSamples& out) const {
+    auto& frames = getKeyframes();
+    bool compiled = compiledVersion == getKeyframeVersion() && compiledInfoVersion == keyframeInfo.getVersion();
+
+    out.startFrame = startFrame;
+    out.count = frames.empty() || !compiled ? 0 : std::max(count, 0);
+    out.previous.resize(out.count);
+    out.next.resize(out.count);
+    out.progress.resize(out.count);
+    out.scratch.resize(out.count);
+    if (out.count == 0) return;
+
+    // find every frame's segment first, frames are in order so it only ever moves forward
+    size_t segment = 0;
+    for (int i = 0; i < out.count; i++) {
+        int frame = startFrame + i - clip->startFrame;
+
+        if (frame < frames.front() || frame >= frames.back()) {
+            int hold = frame < frames.front() ? 0 : frames.size() - 1;
+            out.previous[i] = hold;
+            out.next[i] = hold;
+            out.scratch[i] = 1.0;
+            continue;
+        }
+
+        while (frames[segment + 1] <= frame) segment++;
+        out.previous[i] = segment;
+        out.next[i] = segment + 1;
+        out.scratch[i] = (double)(frame - frames[segment]) / (double)(frames[segment + 1] - frames[segment]);
     }
 
-    debug(previousKeyframe);
-    debug(nextKeyframe);
+    // then ease each run of frames heading into the same keyframe in one go
+    int runStart = 0;
+    for (int i = 1; i <= out.count; i++) {
+        if (i < out.count && out.next[i] == out.next[runStart] && out.previous[i] == out.previous[runStart]) continue;
 
-    updateData(progress, previousKeyframe, nextKeyframe);
+        // held frames aren't eased
+        if (out.previous[runStart] != out.next[runStart]) {
+            animation::easeBatch(easings[out.next[runStart]], &out.scratch[runStart], i - runStart);
+        }
+        runStart = i;
+    }
+
+    for (int i = 0; i < out.count; i++) {
+        out.progress[i] = out.scratch[i];
+    }
 }
 
 void ClipPropertyBase::_drawProperty() {
     drawProperty();
 
-    auto keyframes = getKeyframes();
+    auto& keyframes = getKeyframes();
 
     auto& state = State::get();
 
@@ -115,7 +203,11 @@ void ClipPropertyBase::_drawProperty() {
             state.currentFrame = clip->startFrame + previousKeyframe;
         }
 
-        auto currentEasing = animation::EASING_NAMES[(int)keyframeInfo[nextKeyframe].easing];
+        // read without keyframeInfo[], that would count as an edit and recompile every frame
+        int infoIdx = keyframeInfo.indexOf(nextKeyframe);
+        auto currentInfo = infoIdx >= 0 ? keyframeInfo.valueAt(infoIdx) : PropertyKeyframeMeta {};
+
+        auto currentEasing = animation::EASING_NAMES[(int)currentInfo.easing];
         if (ImGui::BeginCombo(fmt::format("Easing##{}", id).c_str(), currentEasing)) {
             for (int i = 0; i < animation::EASING_NAMES.size(); i++) {
                 auto easingName = animation::EASING_NAMES[i];
@@ -133,7 +225,7 @@ void ClipPropertyBase::_drawProperty() {
             ImGui::EndCombo();
         }
 
-        auto currentMode = animation::EASING_MODE_NAMES[(int)keyframeInfo[nextKeyframe].mode];
+        auto currentMode = animation::EASING_MODE_NAMES[(int)currentInfo.mode];
         if (ImGui::BeginCombo(fmt::format("Mode##{}", id).c_str(), currentMode)) {
             for (int i = 0; i < animation::EASING_MODE_NAMES.size(); i++) {
                 auto modeName = animation::EASING_MODE_NAMES[i];
@@ -1,12 +1,14 @@
 #include <clips/default/image.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
+#include <vector>
 #include <stb_image.h>
 
-#define STB_IMAGE_RESIZE_IMPLEMENTATION
-#include <stb_image_resize2.h>
-
 #include <utils.hpp>
+#include <renderer/backend.hpp>
+#include <renderer/pixel.hpp>
 
 #include <clips/properties/transform.hpp>
 #include <clips/properties/number.hpp>
@@ -33,10 +35,6 @@ namespace clips {
 
         m_metadata.name = std::filesystem::path(path).filename().string();
 
-        glGenBuffers(1, &VBO);
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &EBO);
-
         if (path.empty()) return;
 
         initialize();
@@ -55,24 +53,37 @@ namespace clips {
             return false;
         }
 
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // rgba uploads and samples without any repacking
+        std::vector<uint8_t> pixels((size_t)width * height * 4);
+        pixel::rgbToRGBA(imageData, width * 3, pixels.data(), width * 4, width, height);
+        stbi_image_free(imageData);
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
+        // only the texture shrinks, it's still drawn at the image's own size
+        int textureWidth = width;
+        int textureHeight = height;
+        float fit = std::min(1.f, (float)MAX_TEXTURE_SIZE / std::max(width, height));
+        if (fit < 1.f) {
+            textureWidth = std::max(1, (int)std::floor(width * fit));
+            textureHeight = std::max(1, (int)std::floor(height * fit));
+
+            std::vector<uint8_t> shrunk((size_t)textureWidth * textureHeight * 4);
+            pixel::scaleRGBA(
+                pixels.data(), width * 4, width, height,
+                shrunk.data(), textureWidth * 4, textureWidth, textureHeight,
+                pixel::Filter::Box
+            );
+            pixels = std::move(shrunk);
+        }
 
-        stbi_image_free(imageData);
+        texture = texture::create(texture::Wrap::Repeat);
+        texture::upload(texture, texture::Format::RGBA8, textureWidth, textureHeight, pixels.data());
 
         previewFrame = std::make_shared<Frame>(
             width,
             height
         );
         previewFrame->clearFrame({ 255, 255, 255, 255 });
-        previewFrame->drawTexture(texture, { width, height }, { .position = { 0, 0 } }, VAO, VBO, EBO);
+        previewFrame->drawTexture(texture, { width, height }, { .position = { 0, 0 } });
 
         initialized = true;
 
@@ -104,11 +115,11 @@ namespace clips {
         scaledW = static_cast<int>(std::floor(width * scaleX));
         scaledH = static_cast<int>(std::floor(height * scaleY));
 
-        frame->drawTexture(texture, { scaledW, scaledH }, transform, VAO, VBO, EBO, opacity);
+        frame->drawTexture(texture, { scaledW, scaledH }, transform, opacity);
     }
 
     GLuint ImageClip::getPreviewTexture(int) {
-        return previewFrame->textureID;
+        return previewFrame->getTexture();
     }
 
     Vector2D ImageClip::getPreviewSize() { return { width, height }; }
@@ -18,8 +18,8 @@ void ColorProperty::drawProperty() {
 }
 
 void ColorProperty::updateData(float progress, int previousKeyframe, int nextKeyframe) {
-    RGBAColor previous = keyframes[previousKeyframe];
-    RGBAColor next = keyframes[nextKeyframe];
+    RGBAColor previous = keyframes.valueAt(previousKeyframe);
+    RGBAColor next = keyframes.valueAt(nextKeyframe);
     data = RGBAColor{
         .r = static_cast<int>(utils::interpolate(progress, previous.r, next.r)),
         .g = static_cast<int>(utils::interpolate(progress, previous.g, next.g)),
@@ -23,8 +23,8 @@ void DimensionsProperty::drawProperty() {
 }
 
 void DimensionsProperty::updateData(float progress, int previousKeyframe, int nextKeyframe) {
-    Dimensions previous = keyframes[previousKeyframe];
-    Dimensions next = keyframes[nextKeyframe];
+    Dimensions previous = keyframes.valueAt(previousKeyframe);
+    Dimensions next = keyframes.valueAt(nextKeyframe);
     data = Dimensions{
         .size = {
             .x = static_cast<int>(utils::interpolate(progress, previous.size.x, previous.size.x)),
@@ -27,8 +27,7 @@ void DropdownProperty::drawProperty() {
 // and not continuous, therefore we probably shouldn't try to interpolate this
 // lol
 void DropdownProperty::updateData(float progress, int previousKeyframe, int nextKeyframe) {
-    std::string previous = keyframes[previousKeyframe];
-    data = previous;
+    data = keyframes.valueAt(previousKeyframe);
 }
 
 void DropdownProperty::writeData(qn::HeapByteWriter& writer) {
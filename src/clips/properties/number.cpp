@@ -18,8 +18,8 @@ void NumberProperty::drawProperty() {
 }
 
 void NumberProperty::updateData(float progress, int previousKeyframe, int nextKeyframe) {
-    float previous = keyframes[previousKeyframe];
-    float next = keyframes[nextKeyframe];
+    float previous = keyframes.valueAt(previousKeyframe);
+    float next = keyframes.valueAt(nextKeyframe);
     data = utils::interpolate(progress, previous, next);
 }
 
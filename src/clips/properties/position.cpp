@@ -15,8 +15,8 @@ void PositionProperty::drawProperty() {
 }
 
 void PositionProperty::updateData(float progress, int previousKeyframe, int nextKeyframe) {
-    Vector2D previous = keyframes[previousKeyframe];
-    Vector2D next = keyframes[nextKeyframe];
+    Vector2D previous = keyframes.valueAt(previousKeyframe);
+    Vector2D next = keyframes.valueAt(nextKeyframe);
     data = Vector2D{
         .x = static_cast<int>(utils::interpolate(progress, previous.x, next.x)),
         .y = static_cast<int>(utils::interpolate(progress, previous.y, next.y)),
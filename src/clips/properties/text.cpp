@@ -15,7 +15,7 @@ void TextProperty::drawProperty() {
 
 // TODO: figure out interpolating this lol
 void TextProperty::updateData(float progress, int previousKeyframe, int nextKeyframe) {
-    data = keyframes[previousKeyframe];
+    data = keyframes.valueAt(previousKeyframe);
 }
 
 void TextProperty::writeData(qn::HeapByteWriter& writer) {
@@ -30,6 +30,6 @@ void TextProperty::readData(qn::ByteReader& reader) {
     for (int i = 0; i < size; i++) {
         int frame = reader.readI64().unwrapOr(0);
         std::string value = reader.readStringVar().unwrapOr("FAILED TO READ FROM SAVE; YOU SHOULD NOT SEE THIS!!");
-        keyframes[frame] = debug(value);
+        keyframes[frame] = value;
     }
 }
@@ -20,8 +20,8 @@ void TransformProperty::drawProperty() {
 }
 
 void TransformProperty::updateData(float progress, int previousKeyframe, int nextKeyframe) {
-    Transform previous = keyframes[previousKeyframe];
-    Transform next = keyframes[nextKeyframe];
+    Transform previous = keyframes.valueAt(previousKeyframe);
+    Transform next = keyframes.valueAt(nextKeyframe);
     data = Transform{
         .position = {
             .x = static_cast<int>(utils::interpolate(progress, previous.position.x, next.position.x)),
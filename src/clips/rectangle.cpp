@@ -53,7 +53,7 @@ namespace clips {
     }
 
     GLuint Rectangle::getPreviewTexture(int) {
-        return previewFrame->textureID;
+        return previewFrame->getTexture();
     }
 
     Vector2D Rectangle::getPreviewSize() { return { 500, 500 }; }
@@ -1,6 +1,7 @@
 #include <clips/default/text.hpp>
 
 #include <state.hpp>
+#include <renderer/text.hpp>
 #include <clips/properties/transform.hpp>
 #include <clips/properties/color.hpp>
 #include <clips/properties/text.hpp>
@@ -88,19 +89,44 @@ namespace clips {
         return position;
     }
 
+    void Text::updateLayout() {
+        auto& renderer = State::get().textRenderer;
+        auto& text = getProperty<TextProperty>("text").unwrap()->data;
+        auto& font = getProperty<DropdownProperty>("font").unwrap()->data;
+        float fontSize = getProperty<NumberProperty>("size").unwrap()->data;
+
+        bool changed = !layout || text != layoutText || font != layoutFont || fontSize != layoutSize;
+        if (!changed && renderer->isCurrent(*layout)) return;
+
+        if (font != layoutFont || fontPath.empty()) {
+            fontPath = fmt::format("resources/fonts/{}.ttf", font);
+        }
+
+        layoutText = text;
+        layoutFont = font;
+        layoutSize = fontSize;
+        layout = renderer->layoutText(text, fontPath, fontSize);
+    }
+
     void Text::render(Frame* frame) {
         auto& state = State::get();
-        auto text = getProperty<TextProperty>("text").unwrap()->data;
-        auto font = fmt::format("resources/fonts/{}.ttf", getProperty<DropdownProperty>("font").unwrap()->data);
-        auto fontSize = getProperty<NumberProperty>("size").unwrap()->data;
         auto color = getProperty<ColorProperty>("color").unwrap()->data;
         auto transform = getProperty<TransformProperty>("transform").unwrap()->data;
 
-        size = state.textRenderer->drawText(frame, text, font, transform, color.fade(opacity), fontSize);
+        updateLayout();
+        if (!layout) return;
+
+        size = state.textRenderer->drawLayout(frame, *layout, transform, color.fade(opacity));
+    }
+
+    void Text::hashContent(size_t& seed) {
+        // a stale layout (the font swapped atlases) has to be rebuilt, so draw again
+        bool stale = !layout || !State::get().textRenderer->isCurrent(*layout);
+        utils::hashCombine(seed, utils::hashValue(stale));
     }
 
     GLuint Text::getPreviewTexture(int) {
-        return previewFrame->textureID;
+        return previewFrame->getTexture();
     }
 
     Vector2D Text::getPreviewSize() { return { 500, 500 }; }
@@ -2,9 +2,13 @@
 
 #include <filesystem>
 
+#include <cstring>
 #include <mutex>
 #include <state.hpp>
 #include <utils.hpp>
+#include <renderer/backend.hpp>
+#include <renderer/pixel.hpp>
+#include <renderer/pool.hpp>
 
 #include <clips/properties/transform.hpp>
 #include <clips/properties/number.hpp>
@@ -16,6 +20,12 @@ double roundToNearestN(double value, double n) {
     return std::floor(value / n) * n;
 }
 
+// plane pointers into a packed yuv420p buffer
+static std::array<const uint8_t*, 3> splitI420(const uint8_t* data, int w, int h) {
+    const uint8_t* u = data + w * h;
+    return { data, u, u + (w / 2) * (h / 2) };
+}
+
 
 namespace clips {
     VideoClip::VideoClip(const std::string& path): Clip(10, 60), path(path) {
@@ -49,10 +59,6 @@ namespace clips {
                 ->setName("Start Time")
         );
 
-        glGenBuffers(1, &VBO);
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &EBO);
-
         if (!path.empty()) {
             initialize();
         }
@@ -65,22 +71,9 @@ namespace clips {
             return true;
         }
 
-        auto genTexture = [](GLuint texture) {
-            glBindTexture(GL_TEXTURE_2D, texture);
-            
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        };
-        
-        glGenTextures(1, &textureY);
-        glGenTextures(1, &textureU);
-        glGenTextures(1, &textureV);
-
-        genTexture(textureY);
-        genTexture(textureU);
-        genTexture(textureV);
+        textureY = texture::create(texture::Wrap::Repeat);
+        textureU = texture::create(texture::Wrap::Repeat);
+        textureV = texture::create(texture::Wrap::Repeat);
 
         profile = mlt_profile_init("hdv_720_30p");
         if (profile == NULL) {
@@ -121,7 +114,7 @@ namespace clips {
                         std::scoped_lock guard(this->framesMutex);
                         if (this->previewFrames.contains(frameIdx) || this->finishedFrames.contains(frameIdx)) continue;
                     }
-                    auto res = this->decodeFrameRaw(frameIdx);
+                    auto res = this->decodePreview(frameIdx);
                     {
                         std::scoped_lock guard(this->framesMutex);
                         this->finishedFrames.emplace(frameIdx, std::move(res));
@@ -131,6 +124,8 @@ namespace clips {
             }
         });
 
+        readAhead.fill({ -1, nullptr });
+
         initialized = true;
 
         return true;
@@ -145,16 +140,31 @@ namespace clips {
         return position;
     }
 
+    void VideoClip::onInactive() {
+        joinReadAhead();
+    }
+
     VideoClip::~VideoClip() {
         stopGen.store(true);
+        previewCv.notify_all();
+
+        // both of them use the producer
+        if (previewGenThread.joinable()) previewGenThread.join();
+        joinReadAhead();
+
         mlt_producer_close(producer);
         mlt_profile_close(profile);
     }
 
-    std::array<uint8_t*, 3> VideoClip::decodeFrameRaw(int frameNumber) {
+    FrameCache::Entry VideoClip::decodeSource(int frameNumber) {
+        auto& cache = FrameCache::get();
+        if (auto cached = cache.find(path, frameNumber)) {
+            return cached;
+        }
+
         std::lock_guard<std::mutex> guard(producerMutex);
         if (!producer) {
-            return {};
+            return nullptr;
         }
 
         mlt_producer_seek(producer, frameNumber);
@@ -162,72 +172,274 @@ namespace clips {
         mlt_frame frame = nullptr;
         if (mlt_service_get_frame(MLT_PRODUCER_SERVICE(producer), &frame, 0) != 0) {
             fmt::println("Failed to get frame");
-            return {};
+            return nullptr;
         }
 
         if (!frame) {
             fmt::println("Frame is null");
-            return {};
+            return nullptr;
         }
 
         mlt_image_format format = mlt_image_format::mlt_image_yuv420p;
         uint8_t* image = nullptr;
+        int imageWidth = 0, imageHeight = 0;
 
-        if (mlt_frame_get_image(frame, &image, &format, &width, &height, 0) != 0 || !image) {
+        if (mlt_frame_get_image(frame, &image, &format, &imageWidth, &imageHeight, 0) != 0 || !image) {
             mlt_frame_close(frame);
-            return {};
+            return nullptr;
         }
 
-        uint8_t* y = image;
-        uint8_t* u = y + width * height;
-        uint8_t* v = u + static_cast<int>(std::rint((float)width / 2.f)) * static_cast<int>(std::rint((float)height / 2.f));
+        // the image belongs to the mlt frame, so it has to be copied out before closing it
+        auto decoded = std::make_shared<DecodedFrame>();
+        decoded->width = imageWidth;
+        decoded->height = imageHeight;
+
+        size_t lumaSize = imageWidth * imageHeight;
+        size_t chromaSize = (imageWidth / 2) * (imageHeight / 2);
+        uint8_t* u = image + lumaSize;
+        uint8_t* v = u + static_cast<int>(std::rint((float)imageWidth / 2.f)) * static_cast<int>(std::rint((float)imageHeight / 2.f));
+
+        decoded->data.resize(lumaSize + chromaSize * 2);
+        std::memcpy(decoded->data.data(), image, lumaSize);
+        std::memcpy(decoded->data.data() + lumaSize, u, chromaSize);
+        std::memcpy(decoded->data.data() + lumaSize + chromaSize, v, chromaSize);
 
         mlt_frame_close(frame);
-        return { y, u, v };
+
+        // export walks every frame once, caching those would only push out what's being scrubbed
+        if (!State::get().isExporting) {
+            cache.insert(path, frameNumber, decoded);
+        }
+
+        return decoded;
+    }
+
+    std::shared_ptr<ProxyReader> VideoClip::getProxy() {
+        std::lock_guard guard(proxyMutex);
+        int generation = vpf::getGeneration();
+        if (generation != proxyGeneration) {
+            proxyGeneration = generation;
+            proxy = vpf::hasProxy(path) ? ProxyReader::open(vpf::proxyPathFor(path)) : nullptr;
+        }
+        return proxy;
+    }
+
+    // box filtered down to roughly the pixels it covers once drawn at `scale`
+    // decoded frames are shared with the cache, so this makes a new one
+    static FrameCache::Entry shrinkPreview(const FrameCache::Entry& image, int drawWidth, int drawHeight, float scale) {
+        int width = std::max(2, (int)std::lround(drawWidth * scale) & ~1);
+        int height = std::max(2, (int)std::lround(drawHeight * scale) & ~1);
+        // odd sizes have chroma planes libyuv would read past
+        if (width >= image->width || height >= image->height || image->width % 2 || image->height % 2) return image;
+
+        auto shrunk = std::make_shared<DecodedFrame>();
+        shrunk->width = width;
+        shrunk->height = height;
+        shrunk->data.resize(width * height + (width / 2) * (height / 2) * 2);
+
+        // same packing as DecodedFrame::planes()
+        uint8_t* y = shrunk->data.data();
+        uint8_t* u = y + width * height;
+        uint8_t* v = u + (width / 2) * (height / 2);
+
+        auto src = image->planes();
+        bool ok = pixel::scaleI420(
+            src[0], image->width, src[1], image->width / 2, src[2], image->width / 2,
+            image->width, image->height,
+            y, width, u, width / 2, v, width / 2,
+            width, height,
+            pixel::Filter::Box
+        );
+        return ok ? shrunk : image;
+    }
+
+    VideoClip::PreviewImage VideoClip::decodePreview(int frameNumber) {
+        PreviewImage preview;
+
+        if (auto proxy = getProxy()) {
+            // preview frames are numbered at the producer's frame rate
+            int proxyFrame = fps > 0 ? (int)std::lround((double)frameNumber / fps * proxy->getFPS()) : frameNumber;
+
+            auto decoded = std::make_shared<DecodedFrame>();
+            if (!proxy->readFrame(proxyFrame, decoded->data)) return {};
+            decoded->width = proxy->getWidth();
+            decoded->height = proxy->getHeight();
+
+            preview.image = decoded;
+            preview.drawWidth = proxy->getSourceWidth();
+            preview.drawHeight = proxy->getSourceHeight();
+        } else {
+            preview.image = decodeSource(frameNumber);
+            if (!preview.image) return {};
+
+            preview.drawWidth = preview.image->width;
+            preview.drawHeight = preview.image->height;
+        }
+
+        // done here on the preview thread, so the upload is only as big as the thumbnail
+        preview.image = shrinkPreview(preview.image, preview.drawWidth, preview.drawHeight, PREVIEW_SCALE);
+        return preview;
+    }
+
+    FrameCache::Entry VideoClip::takeReadAhead(int frameNumber) {
+        if (frameNumber < 0) return nullptr;
+
+        std::lock_guard lock(readAheadMutex);
+        auto& [frame, decoded] = readAhead[frameNumber % READ_AHEAD_FRAMES];
+        return frame == frameNumber ? decoded : nullptr;
+    }
+
+    void VideoClip::requestReadAhead(int frameNumber) {
+        {
+            std::lock_guard lock(readAheadMutex);
+
+            if (!readAheadThread.joinable()) {
+                stopReadAhead = false;
+                // whatever was read ahead before going idle is stale, treat it as a seek
+                lastRequestedFrame = -1;
+                readAheadThread = std::thread([this]() { readAheadLoop(); });
+            }
+
+            int step = frameNumber - lastRequestedFrame;
+            int direction = step < 0 ? -1 : 1;
+            bool seeked = lastRequestedFrame < 0 || std::abs(step) >= READ_AHEAD_FRAMES;
+            if (seeked || (step != 0 && direction != readAheadDirection)) {
+                readAhead.fill({ -1, nullptr });
+                readAheadEpoch++;
+            }
+            if (step != 0) readAheadDirection = direction;
+
+            lastRequestedFrame = frameNumber;
+            readAheadFrom = frameNumber;
+        }
+        readAheadCv.notify_one();
+    }
+
+    void VideoClip::joinReadAhead() {
+        if (!readAheadThread.joinable()) return;
+
+        {
+            std::lock_guard lock(readAheadMutex);
+            stopReadAhead = true;
+        }
+        readAheadCv.notify_all();
+        readAheadThread.join();
+
+        std::lock_guard lock(readAheadMutex);
+        readAhead.fill({ -1, nullptr });
+        readAheadFrom = -1;
+        readAheadEpoch++;
+    }
+
+    void VideoClip::readAheadLoop() {
+        std::unique_lock lock(readAheadMutex);
+        while (true) {
+            readAheadCv.wait(lock, [this]() { return stopReadAhead || readAheadFrom >= 0; });
+            if (stopReadAhead) return;
+
+            // nearest frame ahead of the playhead the ring doesn't have yet
+            int next = -1;
+            for (int i = 1; i < READ_AHEAD_FRAMES; i++) {
+                int frame = readAheadFrom + i * readAheadDirection;
+                if (frame < 0) break;
+                if (readAhead[frame % READ_AHEAD_FRAMES].first != frame) {
+                    next = frame;
+                    break;
+                }
+            }
+
+            if (next < 0) {
+                // caught up, sleep until the playhead moves
+                readAheadFrom = -1;
+                continue;
+            }
+
+            int epoch = readAheadEpoch;
+            lock.unlock();
+            auto decoded = decodeSource(next);
+            lock.lock();
+
+            if (!decoded) {
+                // most likely past the end of the file
+                readAheadFrom = -1;
+            } else if (epoch == readAheadEpoch) {
+                readAhead[next % READ_AHEAD_FRAMES] = { next, decoded };
+            }
+        }
     }
 
     bool VideoClip::decodeFrame(int frameNumber) {
-        auto yuv = decodeFrameRaw(frameNumber);
-        if (yuv.size() != 3) {
+        auto& state = State::get();
+
+        auto decoded = takeReadAhead(frameNumber);
+        if (!decoded) decoded = decodeSource(frameNumber);
+        if (!decoded) {
             return false;
         }
 
-        auto y = yuv[0];
-        auto u = yuv[1];
-        auto v = yuv[2];
-
-        // lots of code duplication i know...
-        // this basically runs the more efficient version of
-        // glTexImage2D if we have already uploaded initial data
-        // or else it just doesn't work....
-        if (hasUploaded) {
-            glBindTexture(GL_TEXTURE_2D, textureY);
-            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, y);
-            glBindTexture(GL_TEXTURE_2D, textureU);
-            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width / 2, height / 2, GL_RED, GL_UNSIGNED_BYTE, u);
-            glBindTexture(GL_TEXTURE_2D, textureV);
-            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width / 2, height / 2, GL_RED, GL_UNSIGNED_BYTE, v);
-        } else {
-            glBindTexture(GL_TEXTURE_2D, textureY);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, y);
-            glBindTexture(GL_TEXTURE_2D, textureU);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width / 2, height / 2, 0, GL_RED, GL_UNSIGNED_BYTE, u);
-            glBindTexture(GL_TEXTURE_2D, textureV);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width / 2, height / 2, 0, GL_RED, GL_UNSIGNED_BYTE, v);
+        // the GL thread only uploads while playing / exporting, decoding happens ahead of it
+        if (state.isPlaying || state.isExporting) {
+            requestReadAhead(frameNumber);
+        }
+
+        width = decoded->width;
+        height = decoded->height;
+
+        // scrubbing over the same source frame (or a paused playhead) doesn't need a new upload
+        if (decoded != uploadedData) {
+            uploadYUV(decoded->planes(), decoded->width, decoded->height);
+            uploadedData = decoded;
         }
         return true;
     }
 
+    void VideoClip::uploadYUV(const std::array<const uint8_t*, 3>& planes, int w, int h) {
+        // updating in place is cheaper, but only once the textures have storage of the right size
+        // (switching between the proxy and the source changes it)
+        using texture::Format;
+        if (w == uploadedWidth && h == uploadedHeight) {
+            texture::update(textureY, Format::R8, 0, 0, w, h, planes[0], w);
+            texture::update(textureU, Format::R8, 0, 0, w / 2, h / 2, planes[1], w / 2);
+            texture::update(textureV, Format::R8, 0, 0, w / 2, h / 2, planes[2], w / 2);
+        } else {
+            texture::upload(textureY, Format::R8, w, h, planes[0]);
+            texture::upload(textureU, Format::R8, w / 2, h / 2, planes[1]);
+            texture::upload(textureV, Format::R8, w / 2, h / 2, planes[2]);
+            uploadedWidth = w;
+            uploadedHeight = h;
+        }
+    }
+
     void VideoClip::render(Frame* frame) {
         initialize();
 
         auto& state = State::get();
         int startTime = getProperty<NumberProperty>("start-time").unwrap()->data;
-        int offset = startTime * fps;
-        int targetFrame = std::floor(state.video->timeForFrame(state.currentFrame - startFrame) * (float)fps) + offset;
+
+        // scrubbing and playback read the proxy, export always decodes the source
+        auto proxy = state.isExporting ? nullptr : getProxy();
+        float clipFps = proxy ? (float)proxy->getFPS() : (float)fps;
+
+        int offset = startTime * clipFps;
+        int targetFrame = std::floor(state.video->timeForFrame(state.currentFrame - startFrame) * clipFps) + offset;
         if (targetFrame < 0) return;
 
-        if (!decodeFrame(targetFrame)) return;
+        if (proxy) {
+            auto data = proxy->getFrame(targetFrame);
+            if (!data) return;
+            // the pool decompresses the next few while this one is on screen
+            if (state.isPlaying) proxy->prefetch(targetFrame + 1);
+
+            if (data != uploadedData) {
+                uploadYUV(splitI420(data->data(), proxy->getWidth(), proxy->getHeight()), proxy->getWidth(), proxy->getHeight());
+                uploadedData = data;
+            }
+            // drawn at the source size, only the texture is smaller
+            width = proxy->getSourceWidth();
+            height = proxy->getSourceHeight();
+        } else if (!decodeFrame(targetFrame)) {
+            return;
+        }
 
         float scaleX = (float)getProperty<NumberProperty>("scale-x").unwrap()->data / 100.f;;
         float scaleY = (float)getProperty<NumberProperty>("scale-y").unwrap()->data / 100.f;;
@@ -240,7 +452,15 @@ namespace clips {
         int scaledW = static_cast<int>(std::floor(width * scaleX));
         int scaledH = static_cast<int>(std::floor(height * scaleY));
 
-        frame->drawTextureYUV(textureY, textureU, textureV, { scaledW, scaledH }, transform, VAO, VBO, EBO, opacity);
+        frame->drawTextureYUV(textureY, textureU, textureV, { scaledW, scaledH }, transform, opacity);
+    }
+
+    void VideoClip::hashContent(size_t& seed) {
+        auto& state = State::get();
+        // the source frame follows the playhead, and exporting or a new proxy changes where it's read from
+        utils::hashCombine(seed, utils::hashValue(state.currentFrame - startFrame));
+        utils::hashCombine(seed, utils::hashValue(state.isExporting.load()));
+        utils::hashCombine(seed, utils::hashValue(vpf::getGeneration()));
     }
 
     GLuint VideoClip::getPreviewTexture(int frameIdx) {
@@ -249,64 +469,47 @@ namespace clips {
         {
             std::scoped_lock guard(framesMutex);
             if (previewFrames.contains(frameIdx)) {
-                return previewFrames[frameIdx]->textureID;
+                return previewFrames[frameIdx]->getTexture();
             }
         }
 
         {
             std::scoped_lock guard(framesMutex);
             if (finishedFrames.contains(frameIdx)) {
-                auto genTexture = [](GLuint texture) {
-                    glBindTexture(GL_TEXTURE_2D, texture);
-                    
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-                };
-                
-                GLuint textureY, textureU, textureV;
-    
-                glGenTextures(1, &textureY);
-                glGenTextures(1, &textureU);
-                glGenTextures(1, &textureV);
-    
-                genTexture(textureY);
-                genTexture(textureU);
-                genTexture(textureV);
-    
-                fmt::println("before upload");
-    
-                auto y = finishedFrames[frameIdx][0];
-                auto u = finishedFrames[frameIdx][1];
-                auto v = finishedFrames[frameIdx][2];
-    
-                glBindTexture(GL_TEXTURE_2D, textureY);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, y);
-                glBindTexture(GL_TEXTURE_2D, textureU);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width / 2, height / 2, 0, GL_RED, GL_UNSIGNED_BYTE, u);
-                glBindTexture(GL_TEXTURE_2D, textureV);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width / 2, height / 2, 0, GL_RED, GL_UNSIGNED_BYTE, v);
-    
-                fmt::println("after upload");
+                GLuint textureY = texture::create(texture::Wrap::Repeat);
+                GLuint textureU = texture::create(texture::Wrap::Repeat);
+                GLuint textureV = texture::create(texture::Wrap::Repeat);
     
+                auto& preview = finishedFrames[frameIdx];
+                if (auto& image = preview.image) {
+                    auto planes = image->planes();
+
+                    texture::upload(textureY, texture::Format::R8, image->width, image->height, planes[0]);
+                    texture::upload(textureU, texture::Format::R8, image->width / 2, image->height / 2, planes[1]);
+                    texture::upload(textureV, texture::Format::R8, image->width / 2, image->height / 2, planes[2]);
+                }
+
                 auto res = state.video->getResolution();
-                previewFrames[frameIdx] = std::make_shared<Frame>(
-                    res.x,
-                    res.y
-                );
+                // thumbnails are tiny on the timeline, no need for every pixel
+                previewFrames[frameIdx] = FramePool::get().acquire(res.x, res.y, PREVIEW_SCALE);
                 previewFrames[frameIdx]->clearFrame({ 0, 0, 0, 255 });
-    
-                previewFrames[frameIdx]->drawTextureYUV(
-                    textureY,
-                    textureU,
-                    textureV,
-                    { width, height },
-                    { .position = { 0, 0 } },
-                    VAO,
-                    VBO,
-                    EBO
-                );
+
+                if (preview.image) {
+                    previewFrames[frameIdx]->drawTextureYUV(
+                        textureY,
+                        textureU,
+                        textureV,
+                        { preview.drawWidth, preview.drawHeight },
+                        { .position = { 0, 0 } }
+                    );
+                    // the draw is only queued, it has to go out before the textures are gone
+                    previewFrames[frameIdx]->flush();
+                }
+
+                // the preview frame holds the result, these were only needed to draw it
+                texture::destroy(textureY);
+                texture::destroy(textureU);
+                texture::destroy(textureV);
     
                 finishedFrames.erase(frameIdx);
                 utils::removeFromVector(pendingFrames, frameIdx);
@@ -321,7 +524,7 @@ namespace clips {
                 //     350
                 // );
     
-                return previewFrames[frameIdx]->textureID;
+                return previewFrames[frameIdx]->getTexture();
             }
         }
 
@@ -1,22 +1,49 @@
 #include "utils.hpp"
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <frame.hpp>
 
-#include <shaders/shape.hpp>
-#include <shaders/texture.hpp>
-
-#include <shaders/shader.hpp>
+#include <renderer/backend.hpp>
+#include <renderer/batch.hpp>
+#include <renderer/software.hpp>
 
 #include <glm/gtc/type_ptr.hpp>
 
-Frame::Frame(int width, int height) : width(width), height(height) {
+Frame::Frame(int width, int height, float scale) : width(width), height(height), scale(scale) {
+    textureWidth = getFullTextureWidth();
+    textureHeight = getFullTextureHeight();
+    create();
+}
+
+Frame::Frame(int width, int height, float scale, PixelRect view) : width(width), height(height), scale(scale) {
+    textureWidth = std::max(1, view.width);
+    textureHeight = std::max(1, view.height);
+    viewX = view.x;
+    viewY = view.y;
+    create();
+}
+
+int Frame::textureSizeFor(int size, float scale) {
+    return std::max(1, (int)std::round(size * scale));
+}
+
+void Frame::create() {
+    if (backend::isSoftware()) {
+        // the image is the render target too, so one id does for both
+        textureID = texture::create();
+        texture::upload(textureID, texture::Format::RGBA8, textureWidth, textureHeight, nullptr);
+        fbo = textureID;
+        return;
+    }
+
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_2D, textureID);
     glTexImage2D(
         GL_TEXTURE_2D,
         0,
         GL_RGBA,
-        width, height,
+        textureWidth, textureHeight,
         0,
         GL_RGBA,
         GL_UNSIGNED_BYTE,
@@ -31,42 +58,63 @@ Frame::Frame(int width, int height) : width(width), height(height) {
     glGenFramebuffers(1, &fbo);
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureID, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
 
-    shapeShaderProgram = shader::createProgram(shapeVertex, shapeFragment);
-    texShaderProgram = shader::createProgram(textureVertex, textureFragment);
-    texYUVShaderProgram = shader::createProgram(textureVertex, textureFragmentYUV);
-
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+Frame::~Frame() {
+    // draws into this frame are pointless now, but queued draws elsewhere may still sample it
+    QuadBatch::get().discard(fbo);
+    QuadBatch::get().flush();
 
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
+    if (backend::isSoftware()) {
+        texture::destroy(textureID);
+        return;
+    }
 
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &textureID);
 }
 
 void Frame::clearFrame(RGBAColor color) {
+    if (measuring) return;
+
+    // anything still queued would be cleared over anyway
+    QuadBatch::get().discard(fbo);
+
+    if (backend::isSoftware()) {
+        SoftwareRasterizer::get().clear(fbo, color);
+        return;
+    }
+
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
 
-    glViewport(0, 0, width, height);
+    glViewport(0, 0, textureWidth, textureHeight);
     glClearColor(color.r / 255.f, color.g / 255.f, color.b / 255.f, color.a / 255.f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-std::vector<unsigned char> Frame::getFrameData() {
+const std::vector<unsigned char>& Frame::getFrameData() {
     if (imageData.size() <= 0) {
-        imageData.resize(width * height * 4);
+        imageData.resize(textureWidth * textureHeight * 4);
     }
-    
+
+    flush();
+
+    if (backend::isSoftware()) {
+        if (auto image = SoftwareRasterizer::get().getImage(textureID)) {
+            imageData = image->pixels;
+        }
+        return imageData;
+    }
+
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
 
     glPixelStorei(GL_PACK_ALIGNMENT, 1);
     glReadPixels(
         0, 0,
-        width, height,
+        textureWidth, textureHeight,
         GL_RGBA,
         GL_UNSIGNED_BYTE,
         imageData.data()
@@ -97,6 +145,23 @@ Vector2DF normalizeToOpenGL(Vector2D in, Vector2D resolution) {
 }
 
 glm::mat4 Frame::createBaseMatrix(Vector2DF anchorPoint) {
+    return createViewMatrix() * createCameraMatrix();
+}
+
+glm::mat4 Frame::createViewMatrix() {
+    float fullWidth = getFullTextureWidth();
+    float fullHeight = getFullTextureHeight();
+
+    // scaled up around the view and moved so it fills -1..1
+    glm::mat4 view(1.f);
+    view[0][0] = fullWidth / textureWidth;
+    view[1][1] = fullHeight / textureHeight;
+    view[3][0] = (fullWidth - 2.f * viewX - textureWidth) / textureWidth;
+    view[3][1] = (fullHeight - 2.f * viewY - textureHeight) / textureHeight;
+    return view;
+}
+
+glm::mat4 Frame::createCameraMatrix() {
     // anchorPoint.x = std::clamp(anchorPoint.x, 0.f, 1.f);
     // anchorPoint.y = std::clamp(anchorPoint.y, 0.f, 1.f);
 
@@ -151,256 +216,177 @@ glm::mat4 Frame::createModelFromTransform(Transform transform, Vector2D pos, Vec
     return model * glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, -1.0f, 1.0f));
 }
 
-void Frame::primitiveDraw(Transform transform, Vector2D size, RGBAColor color, ShapeType type) {
-    Vector2D pos = transform.position - size / 2;
-    Vector2D resolution = { width, height };
-
+// the corners are transformed here instead of in the vertex shader,
+// so quads with different transforms can go out in the same draw
+static Quad makeQuad(const glm::mat4& matrix, Vector2D size, std::array<float, 4> color, std::array<float, 4> shape = {}) {
     float halfW = size.x * 0.5f;
     float halfH = size.y * 0.5f;
 
-    // top left
-    Vector2D tl = pos;
-    // top right
-    Vector2D tr = { pos.x + size.x, pos.y };
-    // bottom left
-    Vector2D bl = { pos.x, pos.y + size.y };
-    // bottom right
-    Vector2D br = { pos.x + size.x, pos.y + size.y };
-
-    float vertices[] = {
-        -halfW,  halfH, 0.0f,   // top left 
-        halfW,  halfH, 0.0f,  // top right
-        -halfW, -halfH, 0.0f,  // bottom left
-        halfW, -halfH, 0.0f  // bottom right
+    // x, y, u, v
+    const float corners[4][4] = {
+        { -halfW,  halfH, 0.0f, 1.0f }, // top left
+        {  halfW,  halfH, 1.0f, 1.0f }, // top right
+        { -halfW, -halfH, 0.0f, 0.0f }, // bottom left
+        {  halfW, -halfH, 1.0f, 0.0f }  // bottom right
     };
-    unsigned int indices[] = {  // note that we start from 0!
-        0, 1, 3,   // first triangle
-        0, 2, 3    // second triangle
-    };
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    Quad quad;
+    for (int i = 0; i < 4; i++) {
+        glm::vec4 pos = matrix * glm::vec4(corners[i][0], corners[i][1], 0.0f, 1.0f);
+        quad[i] = {
+            pos.x, pos.y, pos.z, pos.w,
+            corners[i][2], corners[i][3],
+            color[0], color[1], color[2], color[3],
+            shape[0], shape[1], shape[2], shape[3]
+        };
+    }
+    return quad;
+}
 
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+void Frame::primitiveDraw(Transform transform, Vector2D size, RGBAColor color, ShapeType type) {
+    Vector2D pos = transform.position - size / 2;
 
     glm::mat4 matrix = createBaseMatrix(transform.anchorPoint);
     glm::mat4 model = createModelFromTransform(transform, pos, size);
 
     matrix = matrix * model;
 
-    glUseProgram(shapeShaderProgram);
-    glUniform4f(
-        glGetUniformLocation(shapeShaderProgram, "outColor"),
-        color.r / 255.f, color.g / 255.f, color.b / 255.f, color.a / 255.f
-    );
-    glUniform2f(
-        glGetUniformLocation(shapeShaderProgram, "screenSize"),
-        (float)resolution.x, (float)resolution.y
-    );
-    glUniform1i(
-        glGetUniformLocation(shapeShaderProgram, "type"),
-        (int)type
-    );
-    glUniformMatrix4fv(
-        glGetUniformLocation(shapeShaderProgram, "matrix"),
-        1, GL_FALSE, glm::value_ptr(matrix)
-    );
+    std::array<float, 4> shape = { (float)type, 0.f, 0.f, 0.f };
     if (type == ShapeType::Circle) {
-        glUniform1f(
-            glGetUniformLocation(shapeShaderProgram, "radius"),
-            size.x / 2.f
-        );
-        glUniform2f(
-            glGetUniformLocation(shapeShaderProgram, "center"),
-            (pos.x + (width * transform.anchorPoint.x)) + (size.x / 2.f),
-            (pos.y + (height * transform.anchorPoint.y)) + (size.y / 2.f)
-        );
+        // compared against gl_FragCoord, so these are in texture pixels
+        shape[1] = size.x / 2.f * scale;
+        shape[2] = ((pos.x + (width * transform.anchorPoint.x)) + (size.x / 2.f)) * scale - viewX;
+        shape[3] = ((pos.y + (height * transform.anchorPoint.y)) + (size.y / 2.f)) * scale - viewY;
     }
 
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    submit(
+        QuadBatch::Program::Shape, {},
+        makeQuad(matrix, size, { color.r / 255.f, color.g / 255.f, color.b / 255.f, color.a / 255.f }, shape)
+    );
 }
 
 void Frame::drawRect(Dimensions dimensions, RGBAColor color) {
     primitiveDraw(dimensions.transform, dimensions.size, color);
 }
 
-void Frame::drawTexture(GLuint texture, Vector2D size, Transform transform, GLuint VAO, GLuint VBO, GLuint EBO, float opacity) {
+void Frame::drawTexture(GLuint texture, Vector2D size, Transform transform, float opacity) {
     Vector2D pos = transform.position - size / 2;
-    // stolen from the primitive draw lmao
-    Vector2D resolution = { width, height };
-
-    // top left
-    Vector2D tl = pos;
-    // top right
-    Vector2D tr = { pos.x + size.x, pos.y };
-    // bottom left
-    Vector2D bl = { pos.x, pos.y + size.y };
-    // bottom right
-    Vector2D br = pos + size;
-
-    float left = -transform.anchorPoint.x * size.x;
-    float right = (1.f - transform.anchorPoint.x) * size.x;
-    float top = (1.f - transform.anchorPoint.y) * size.y;
-    float bottom = -transform.anchorPoint.y * size.y;
-
-    float halfW = size.x * 0.5f;
-    float halfH = size.y * 0.5f;
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-
-    float vertices[] = {
-        -halfW,  halfH, 0.0f, 0.0f, 1.0f,   // top left 
-        halfW,  halfH, 0.0f, 1.0f, 1.0f,  // top right
-        -halfW, -halfH, 0.0f, 0.0f, 0.0f,  // bottom left
-        halfW, -halfH, 0.0f, 1.0f, 0.0f  // bottom right
-    };
-
-    unsigned int indices[] = {  // note that we start from 0!
-        0, 1, 3,   // first triangle
-        0, 2, 3    // second triangle
-    };
-
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
 
     glm::mat4 matrix = createBaseMatrix(transform.anchorPoint);
     glm::mat4 model = createModelFromTransform(transform, pos, size);
 
     matrix = matrix * model;
 
-    glUseProgram(texShaderProgram);
-    glUniform1i(
-        glGetUniformLocation(texShaderProgram, "texture1"),
-        0
-    );
-    glUniform1f(
-        glGetUniformLocation(texShaderProgram, "opacity"),
-        opacity
+    submit(
+        QuadBatch::Program::Texture, { texture, 0, 0 },
+        makeQuad(matrix, size, { 1.f, 1.f, 1.f, opacity })
     );
-    glUniformMatrix4fv(
-        glGetUniformLocation(texShaderProgram, "matrix"),
-        1, GL_FALSE, glm::value_ptr(matrix)
-    );
-
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
-void Frame::drawTextureYUV(GLuint textureY, GLuint textureU, GLuint textureV, Vector2D size, Transform transform, GLuint VAO, GLuint VBO, GLuint EBO, float opacity) {
+void Frame::drawTextureYUV(GLuint textureY, GLuint textureU, GLuint textureV, Vector2D size, Transform transform, float opacity) {
     Vector2D pos = transform.position - size / 2;
-    // stolen from the primitive draw lmao
-    Vector2D resolution = { width, height };
-
-    // top left
-    Vector2D tl = pos;
-    // top right
-    Vector2D tr = { pos.x + size.x, pos.y };
-    // bottom left
-    Vector2D bl = { pos.x, pos.y + size.y };
-    // bottom right
-    Vector2D br = { pos.x + size.x, pos.y + size.y };
-
-    float halfW = size.x * 0.5f;
-    float halfH = size.y * 0.5f;
 
-    float vertices[] = {
-        -halfW,  halfH, 0.0f, 0.0f, 1.0f,   // top left 
-        halfW,  halfH, 0.0f, 1.0f, 1.0f,  // top right
-        -halfW, -halfH, 0.0f, 0.0f, 0.0f,  // bottom left
-        halfW, -halfH, 0.0f, 1.0f, 0.0f  // bottom right
-    };
+    glm::mat4 model = createModelFromTransform(transform, pos, size);
+    glm::mat4 flipY = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, -1.0f, 1.0f));
 
-    unsigned int indices[] = {  // note that we start from 0!
-        0, 1, 3,   // first triangle
-        0, 2, 3    // second triangle
-    };
+    // flipped in the full frame, before it's narrowed down to the view
+    glm::mat4 matrix = createViewMatrix() * flipY * createCameraMatrix() * model;
 
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    submit(
+        QuadBatch::Program::TextureYUV, { textureY, textureU, textureV },
+        makeQuad(matrix, size, { 1.f, 1.f, 1.f, opacity })
+    );
+}
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+void Frame::drawLayer(Frame* layer, float opacity) {
+    // straight to clip space, the layer already went through the camera
+    // only over the part of this frame the layer's texture covers
+    float left = (float)(layer->viewX - viewX) / textureWidth * 2.f - 1.f;
+    float right = (float)(layer->viewX + layer->textureWidth - viewX) / textureWidth * 2.f - 1.f;
+    float bottom = (float)(layer->viewY - viewY) / textureHeight * 2.f - 1.f;
+    float top = (float)(layer->viewY + layer->textureHeight - viewY) / textureHeight * 2.f - 1.f;
+
+    Quad quad;
+    const float corners[4][4] = {
+        { left,  top,    0.0f, 1.0f }, // top left
+        { right, top,    1.0f, 1.0f }, // top right
+        { left,  bottom, 0.0f, 0.0f }, // bottom left
+        { right, bottom, 1.0f, 0.0f }  // bottom right
+    };
+    for (int i = 0; i < 4; i++) {
+        quad[i] = {
+            corners[i][0], corners[i][1], 0.0f, 1.0f,
+            corners[i][2], corners[i][3],
+            opacity, opacity, opacity, opacity
+        };
+    }
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    submit(QuadBatch::Program::Layer, { layer->getTexture(), 0, 0 }, quad);
+}
 
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+void Frame::submit(QuadBatch::Program program, std::array<GLuint, 3> textures, const Quad& quad) {
+    if (!measuring) {
+        QuadBatch::get().add(fbo, textureWidth, textureHeight, program, textures, quad);
+        return;
+    }
 
-    glm::mat4 matrix = createBaseMatrix(transform.anchorPoint);
-    glm::mat4 model = createModelFromTransform(transform, pos, size);
-    glm::mat4 flipY = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, -1.0f, 1.0f));
+    for (auto& vertex : quad) {
+        // behind the camera, it could land anywhere
+        if (vertex.w <= 0.f) {
+            measuredMinX = measuredMinY = -INFINITY;
+            measuredMaxX = measuredMaxY = INFINITY;
+            return;
+        }
 
-    matrix = flipY * matrix * model;
+        // same mapping as the rasterizer, then moved out of the view
+        float x = (vertex.x / vertex.w * 0.5f + 0.5f) * textureWidth + viewX;
+        float y = (vertex.y / vertex.w * 0.5f + 0.5f) * textureHeight + viewY;
+        measuredMinX = std::min(measuredMinX, x);
+        measuredMinY = std::min(measuredMinY, y);
+        measuredMaxX = std::max(measuredMaxX, x);
+        measuredMaxY = std::max(measuredMaxY, y);
+    }
+}
 
-    glUseProgram(texYUVShaderProgram);
-    glUniform1i(
-        glGetUniformLocation(texYUVShaderProgram, "textureY"),
-        0
-    );
-    glUniform1i(
-        glGetUniformLocation(texYUVShaderProgram, "textureU"),
-        1
-    );
-    glUniform1i(
-        glGetUniformLocation(texYUVShaderProgram, "textureV"),
-        2
-    );
-    glUniform1f(
-        glGetUniformLocation(texYUVShaderProgram, "opacity"),
-        opacity
-    );
-    glUniformMatrix4fv(
-        glGetUniformLocation(texYUVShaderProgram, "matrix"),
-        1, GL_FALSE, glm::value_ptr(matrix)
-    );
+void Frame::beginMeasure() {
+    measuring = true;
+    measuredMinX = measuredMinY = INFINITY;
+    measuredMaxX = measuredMaxY = -INFINITY;
+}
 
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+std::optional<PixelRect> Frame::endMeasure() {
+    measuring = false;
+    if (measuredMinX > measuredMaxX || measuredMinY > measuredMaxY) return std::nullopt;
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureY);
+    // a pixel of slack for linear filtering and antialiased edges
+    float fullWidth = getFullTextureWidth();
+    float fullHeight = getFullTextureHeight();
+    int left = (int)std::clamp(std::floor(measuredMinX) - 1.f, 0.f, fullWidth);
+    int bottom = (int)std::clamp(std::floor(measuredMinY) - 1.f, 0.f, fullHeight);
+    int right = (int)std::clamp(std::ceil(measuredMaxX) + 1.f, 0.f, fullWidth);
+    int top = (int)std::clamp(std::ceil(measuredMaxY) + 1.f, 0.f, fullHeight);
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, textureU);
+    if (left >= right || bottom >= top) return std::nullopt;
+    return PixelRect { left, bottom, right - left, top - bottom };
+}
 
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, textureV);
+void Frame::measure(const glm::mat4& matrix, Vector2DF min, Vector2DF max) {
+    Quad quad;
+    const float corners[4][2] = { { min.x, min.y }, { max.x, min.y }, { min.x, max.y }, { max.x, max.y } };
+    for (int i = 0; i < 4; i++) {
+        glm::vec4 pos = matrix * glm::vec4(corners[i][0], corners[i][1], 0.0f, 1.0f);
+        quad[i] = { pos.x, pos.y, pos.z, pos.w };
+    }
+    submit(QuadBatch::Program::Shape, {}, quad);
+}
 
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+void Frame::flush() {
+    QuadBatch::get().flush(fbo);
+}
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+GLuint Frame::getTexture() {
+    flush();
+    return textureID;
 }
 
 void Frame::drawLine(Vector2D start, Vector2D end, RGBAColor color, int thickness) {
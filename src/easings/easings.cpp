@@ -18,6 +18,48 @@ namespace animation {
         return EASING_FUNCTIONS[easingIndex][modeIndex];
     }
 
+    // the easings are defined below in this file, so each instance gets its own copy inlined
+    template <EasingFunction Function>
+    static void batch(double* values, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            values[i] = Function(values[i]);
+        }
+    }
+
+    static const EasingBatchFunction EASING_BATCH_FUNCTIONS[][3] = {
+        {batch<easing::linear>,        batch<easing::linear>,         batch<easing::linear>},
+        {batch<easing::easeInSine>,    batch<easing::easeOutSine>,    batch<easing::easeInOutSine>},
+        {batch<easing::easeInQuad>,    batch<easing::easeOutQuad>,    batch<easing::easeInOutQuad>},
+        {batch<easing::easeInCubic>,   batch<easing::easeOutCubic>,   batch<easing::easeInOutCubic>},
+        {batch<easing::easeInQuart>,   batch<easing::easeOutQuart>,   batch<easing::easeInOutQuart>},
+        {batch<easing::easeInQuint>,   batch<easing::easeOutQuint>,   batch<easing::easeInOutQuint>},
+        {batch<easing::easeInExpo>,    batch<easing::easeOutExpo>,    batch<easing::easeInOutExpo>},
+        {batch<easing::easeInCirc>,    batch<easing::easeOutCirc>,    batch<easing::easeInOutCirc>},
+        {batch<easing::easeInBack>,    batch<easing::easeOutBack>,    batch<easing::easeInOutBack>},
+        {batch<easing::easeInElastic>, batch<easing::easeOutElastic>, batch<easing::easeInOutElastic>},
+        {batch<easing::easeInBounce>,  batch<easing::easeOutBounce>,  batch<easing::easeInOutBounce>},
+    };
+
+    EasingBatchFunction getEasingBatchFunction(EasingFunction function) {
+        for (size_t i = 0; i < EASING_COUNT; i++) {
+            for (size_t j = 0; j < 3; j++) {
+                if (EASING_FUNCTIONS[i][j] == function) return EASING_BATCH_FUNCTIONS[i][j];
+            }
+        }
+        return nullptr;
+    }
+
+    void easeBatch(EasingFunction function, double* values, size_t count) {
+        if (auto batchFunction = getEasingBatchFunction(function)) {
+            batchFunction(values, count);
+            return;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            values[i] = function(values[i]);
+        }
+    }
+
     namespace easing {
         double linear(double t) {
             return t;
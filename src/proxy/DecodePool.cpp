@@ -0,0 +1,55 @@
+#include <proxy/pool.hpp>
+
+#include <algorithm>
+
+#include <zstd.h>
+
+ProxyDecodePool::ProxyDecodePool(int workerCount) {
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+ProxyDecodePool::~ProxyDecodePool() {
+    {
+        std::lock_guard lock(jobsMutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobsCv.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+ProxyDecodePool& ProxyDecodePool::get() {
+    // decompressing a 720p frame is ~1ms, two threads keep well ahead of playback
+    // without fighting the UI and mlt for cores
+    static ProxyDecodePool instance(std::clamp((int)std::thread::hardware_concurrency() / 4, 1, 2));
+    return instance;
+}
+
+void ProxyDecodePool::submit(Job job) {
+    {
+        std::lock_guard lock(jobsMutex);
+        jobs.push_back(std::move(job));
+    }
+    jobsCv.notify_one();
+}
+
+void ProxyDecodePool::workerLoop() {
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock lock(jobsMutex);
+            jobsCv.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) break;
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job(dctx);
+    }
+
+    ZSTD_freeDCtx(dctx);
+}
@@ -0,0 +1,210 @@
+#include <proxy/reader.hpp>
+#include <proxy/pool.hpp>
+
+#include <algorithm>
+
+#include <fmt/base.h>
+#include <zstd.h>
+
+ProxyReader::ProxyReader(std::string path): path(path) {}
+
+ProxyReader::~ProxyReader() {
+    ZSTD_freeDCtx(dctx);
+}
+
+std::shared_ptr<ProxyReader> ProxyReader::open(const std::string& path) {
+    auto reader = std::shared_ptr<ProxyReader>(new ProxyReader(path));
+    if (!reader->load()) return nullptr;
+    return reader;
+}
+
+bool ProxyReader::load() {
+    if (!file.open(path)) return false;
+
+    auto bytes = file.bytes();
+    if (bytes.size() < vpf::Header::SIZE) {
+        fmt::println("proxy: {} is too short", path);
+        return false;
+    }
+
+    qn::ByteReader reader(bytes);
+    if (!header.read(reader) || header.frameCount == 0) {
+        fmt::println("proxy: {} is not a valid proxy", path);
+        return false;
+    }
+
+    size_t indexSize = (size_t)header.frameCount * vpf::IndexEntry::SIZE;
+    if (header.indexOffset > bytes.size() || bytes.size() - header.indexOffset < indexSize) {
+        fmt::println("proxy: {} has a truncated index", path);
+        return false;
+    }
+
+    // entries are stored in frame order, but don't trust that blindly
+    reader.setPosition(header.indexOffset);
+    index.resize(header.frameCount);
+    for (uint32_t i = 0; i < header.frameCount; i++) {
+        vpf::IndexEntry entry;
+        entry.frame = reader.readU32().unwrapOr(UINT32_MAX);
+        entry.offset = reader.readU64().unwrapOr(0);
+        entry.size = reader.readU32().unwrapOr(0);
+        // written so a huge offset can't wrap around and pass
+        bool outside = entry.offset < vpf::Header::SIZE || entry.offset > header.indexOffset
+            || entry.size > header.indexOffset - entry.offset;
+        if (entry.frame >= header.frameCount || outside) {
+            fmt::println("proxy: {} has a bad index entry", path);
+            return false;
+        }
+        index[entry.frame] = entry;
+    }
+
+    dctx = ZSTD_createDCtx();
+    return dctx != nullptr;
+}
+
+int ProxyReader::clampFrame(int frame) const {
+    return std::clamp(frame, 0, (int)index.size() - 1);
+}
+
+std::span<const uint8_t> ProxyReader::getCompressed(int frame) const {
+    auto& entry = index[clampFrame(frame)];
+    return file.bytes().subspan(entry.offset, entry.size);
+}
+
+bool ProxyReader::decompress(ZSTD_DCtx_s* ctx, int frame, std::vector<uint8_t>& out) const {
+    auto compressed = getCompressed(frame);
+    out.resize(getFrameSize());
+
+    size_t size = ZSTD_decompressDCtx(ctx, out.data(), out.size(), compressed.data(), compressed.size());
+    if (ZSTD_isError(size) || size != out.size()) {
+        fmt::println("proxy: frame {} of {} is corrupt", frame, path);
+        return false;
+    }
+
+    return true;
+}
+
+bool ProxyReader::readFrame(int frame, std::vector<uint8_t>& out) {
+    if (frame < 0) return false;
+
+    std::lock_guard lock(dctxMutex);
+    return decompress(dctx, clampFrame(frame), out);
+}
+
+ProxyReader::Buffer ProxyReader::acquireBuffer() {
+    // a buffer someone is still holding through a FrameData (the frame on screen, say)
+    // is skipped but stays pooled, it's free again once they let go
+    for (auto it = freeBuffers.begin(); it != freeBuffers.end(); ++it) {
+        if (it->use_count() != 1) continue;
+
+        auto buffer = std::move(*it);
+        *it = std::move(freeBuffers.back());
+        freeBuffers.pop_back();
+        return buffer;
+    }
+    return std::make_shared<std::vector<uint8_t>>();
+}
+
+void ProxyReader::trim(int first, int count) {
+    for (auto it = frames.begin(); it != frames.end();) {
+        if (it->first >= first && it->first < first + count) {
+            ++it;
+            continue;
+        }
+
+        // in flight ones are dropped too, their job sees that and skips the work
+        if (freeBuffers.size() < PREFETCH_FRAMES * 2) {
+            freeBuffers.push_back(std::move(it->second.buffer));
+        }
+        it = frames.erase(it);
+    }
+}
+
+ProxyReader::FrameData ProxyReader::getFrame(int frame) {
+    if (frame < 0) return nullptr;
+    frame = clampFrame(frame);
+
+    Buffer buffer;
+    {
+        std::unique_lock lock(framesMutex);
+        framesCv.wait(lock, [&]() {
+            auto it = frames.find(frame);
+            return it == frames.end() || it->second.ready;
+        });
+
+        auto it = frames.find(frame);
+        if (it != frames.end()) return it->second.buffer;
+
+        buffer = acquireBuffer();
+    }
+
+    // not prefetched (a seek, or playback hasn't started), so this one does block
+    {
+        std::lock_guard lock(dctxMutex);
+        if (!decompress(dctx, frame, *buffer)) return nullptr;
+    }
+
+    std::lock_guard lock(framesMutex);
+    trim(frame, PREFETCH_FRAMES);
+    frames.try_emplace(frame, CachedFrame { buffer, true });
+    return buffer;
+}
+
+void ProxyReader::prefetch(int first, int count) {
+    first = std::max(first, 0);
+    count = std::min(count, (int)index.size() - first);
+
+    // get the page cache reading the window in before the workers touch it
+    if (count > 0) {
+        size_t start = SIZE_MAX, end = 0;
+        for (int frame = first; frame < first + count; frame++) {
+            auto& entry = index[frame];
+            start = std::min<size_t>(start, entry.offset);
+            end = std::max<size_t>(end, entry.offset + entry.size);
+        }
+        file.willNeed(start, end - start);
+    }
+
+    std::unique_lock lock(framesMutex);
+    // keep the frame just before the window, it's usually the one on screen
+    trim(first - 1, count + 1);
+
+    for (int frame = first; frame < first + count; frame++) {
+        if (frames.contains(frame)) continue;
+
+        auto buffer = acquireBuffer();
+        frames[frame] = { buffer, false };
+
+        ProxyDecodePool::get().submit([self = shared_from_this(), frame, buffer](ZSTD_DCtx_s* ctx) {
+            auto wanted = [&]() {
+                auto it = self->frames.find(frame);
+                return it != self->frames.end() && it->second.buffer == buffer;
+            };
+
+            {
+                std::lock_guard lock(self->framesMutex);
+                if (!wanted()) {
+                    self->framesCv.notify_all();
+                    return;
+                }
+            }
+
+            bool success = self->decompress(ctx, frame, *buffer);
+
+            {
+                std::lock_guard lock(self->framesMutex);
+                if (wanted()) {
+                    if (success) {
+                        self->frames[frame].ready = true;
+                    } else {
+                        self->frames.erase(frame);
+                    }
+                }
+            }
+            self->framesCv.notify_all();
+        });
+    }
+
+    // anyone waiting on a frame that just got trimmed decodes it themselves
+    lock.unlock();
+    framesCv.notify_all();
+}
@@ -0,0 +1,261 @@
+#include <proxy/writer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <fmt/base.h>
+#include <zstd.h>
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+    #include <libavformat/avformat.h>
+    #include <libavutil/imgutils.h>
+    #include <libswscale/swscale.h>
+}
+
+// fits the source inside MAX_WIDTH x MAX_HEIGHT without upscaling, keeping both sides even
+static void proxySize(int sourceW, int sourceH, int& outW, int& outH) {
+    double scale = std::min({ 1.0, (double)vpf::MAX_WIDTH / sourceW, (double)vpf::MAX_HEIGHT / sourceH });
+    outW = std::max(2, (int)std::lround(sourceW * scale) & ~1);
+    outH = std::max(2, (int)std::lround(sourceH * scale) & ~1);
+}
+
+ProxyWriter::ProxyWriter(std::string sourcePath): sourcePath(sourcePath), outputPath(vpf::proxyPathFor(sourcePath)) {}
+
+bool ProxyWriter::write() {
+    AVFormatContext* fmt_ctx = nullptr;
+    AVCodecContext* dec_ctx = nullptr;
+    const AVCodec* decoder = nullptr;
+    AVStream* stream = nullptr;
+    AVFrame* frame = nullptr;
+    AVFrame* scaled = nullptr;
+    AVPacket* pkt = nullptr;
+    SwsContext* sws_ctx = nullptr;
+    ZSTD_CCtx* cctx = nullptr;
+
+    int streamIndex = -1;
+    int64_t firstPts = AV_NOPTS_VALUE;
+    AVRational fps;
+    AVRational frameTime;
+
+    vpf::Header header;
+    std::vector<vpf::IndexEntry> index;
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> compressed;
+    std::ofstream out;
+    uint64_t offset = 0;
+    bool success = false;
+
+    std::string partPath = outputPath + ".part";
+
+    // compresses the scaled frame and appends it, duplicating the last entry
+    // for any frames the source skipped (variable frame rate, dropped frames)
+    auto writeFrame = [&](int64_t frameNum) -> bool {
+        if (frameNum < (int64_t)index.size()) return true;
+
+        while ((int64_t)index.size() < frameNum && !index.empty()) {
+            auto last = index.back();
+            last.frame = index.size();
+            index.push_back(last);
+        }
+
+        av_image_copy_to_buffer(
+            raw.data(), raw.size(),
+            scaled->data, scaled->linesize,
+            AV_PIX_FMT_YUV420P, header.width, header.height, 1
+        );
+
+        size_t size = ZSTD_compressCCtx(cctx, compressed.data(), compressed.size(), raw.data(), raw.size(), vpf::ZSTD_LEVEL);
+        if (ZSTD_isError(size)) {
+            fmt::println("could not compress proxy frame: {}", ZSTD_getErrorName(size));
+            return false;
+        }
+
+        out.write((const char*)compressed.data(), size);
+        index.push_back({
+            .frame = (uint32_t)index.size(),
+            .offset = offset,
+            .size = (uint32_t)size
+        });
+        offset += size;
+
+        return out.good();
+    };
+
+    auto receiveFrames = [&]() -> bool {
+        while (avcodec_receive_frame(dec_ctx, frame) >= 0) {
+            int64_t pts = frame->best_effort_timestamp;
+            if (pts == AV_NOPTS_VALUE) pts = firstPts == AV_NOPTS_VALUE ? 0 : firstPts;
+            if (firstPts == AV_NOPTS_VALUE) firstPts = pts;
+
+            int64_t frameNum = av_rescale_q_rnd(
+                pts - firstPts, stream->time_base, frameTime,
+                (AVRounding)(AV_ROUND_NEAR_INF | AV_ROUND_PASS_MINMAX)
+            );
+
+            sws_scale(sws_ctx, frame->data, frame->linesize, 0, frame->height, scaled->data, scaled->linesize);
+            av_frame_unref(frame);
+
+            if (!writeFrame(std::max<int64_t>(frameNum, 0))) return false;
+        }
+        return true;
+    };
+
+    if (avformat_open_input(&fmt_ctx, sourcePath.c_str(), nullptr, nullptr) < 0) {
+        fmt::println("proxy: could not open {}", sourcePath);
+        goto cleanup;
+    }
+
+    if (avformat_find_stream_info(fmt_ctx, nullptr) < 0) {
+        goto cleanup;
+    }
+
+    streamIndex = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, &decoder, 0);
+    if (streamIndex < 0 || !decoder) {
+        fmt::println("proxy: no video stream in {}", sourcePath);
+        goto cleanup;
+    }
+    stream = fmt_ctx->streams[streamIndex];
+
+    dec_ctx = avcodec_alloc_context3(decoder);
+    if (!dec_ctx || avcodec_parameters_to_context(dec_ctx, stream->codecpar) < 0) {
+        goto cleanup;
+    }
+    dec_ctx->thread_count = 0;
+    if (avcodec_open2(dec_ctx, decoder, nullptr) < 0) {
+        fmt::println("proxy: could not open decoder for {}", sourcePath);
+        goto cleanup;
+    }
+
+    fps = av_guess_frame_rate(fmt_ctx, stream, nullptr);
+    if (fps.num <= 0 || fps.den <= 0) fps = { 30, 1 };
+    frameTime = av_inv_q(fps);
+
+    header.sourceWidth = dec_ctx->width;
+    header.sourceHeight = dec_ctx->height;
+    header.fpsNum = fps.num;
+    header.fpsDen = fps.den;
+    {
+        int w, h;
+        proxySize(dec_ctx->width, dec_ctx->height, w, h);
+        header.width = w;
+        header.height = h;
+    }
+
+    sws_ctx = sws_getContext(
+        dec_ctx->width, dec_ctx->height, dec_ctx->pix_fmt,
+        header.width, header.height, AV_PIX_FMT_YUV420P,
+        SWS_BILINEAR, nullptr, nullptr, nullptr
+    );
+    if (!sws_ctx) {
+        goto cleanup;
+    }
+
+    frame = av_frame_alloc();
+    scaled = av_frame_alloc();
+    pkt = av_packet_alloc();
+    cctx = ZSTD_createCCtx();
+    if (!frame || !scaled || !pkt || !cctx) {
+        goto cleanup;
+    }
+
+    scaled->format = AV_PIX_FMT_YUV420P;
+    scaled->width = header.width;
+    scaled->height = header.height;
+    if (av_frame_get_buffer(scaled, 0) < 0) {
+        goto cleanup;
+    }
+
+    raw.resize(header.getFrameSize());
+    compressed.resize(ZSTD_compressBound(raw.size()));
+
+    out.open(partPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        fmt::println("proxy: could not write {}", partPath);
+        goto cleanup;
+    }
+
+    // placeholder, rewritten once the frame count and index offset are known
+    {
+        qn::HeapByteWriter writer;
+        header.write(writer);
+        auto data = writer.written();
+        out.write((const char*)data.data(), data.size());
+        offset = data.size();
+    }
+
+    while (av_read_frame(fmt_ctx, pkt) >= 0) {
+        if (pkt->stream_index == streamIndex) {
+            if (avcodec_send_packet(dec_ctx, pkt) < 0 || !receiveFrames()) {
+                av_packet_unref(pkt);
+                goto cleanup;
+            }
+        }
+        av_packet_unref(pkt);
+    }
+
+    avcodec_send_packet(dec_ctx, nullptr);
+    if (!receiveFrames() || index.empty()) {
+        goto cleanup;
+    }
+
+    header.frameCount = index.size();
+    header.indexOffset = offset;
+
+    {
+        qn::HeapByteWriter writer;
+        for (auto& entry : index) {
+            writer.writeU32(entry.frame);
+            writer.writeU64(entry.offset);
+            writer.writeU32(entry.size);
+        }
+        auto data = writer.written();
+        out.write((const char*)data.data(), data.size());
+    }
+
+    {
+        qn::HeapByteWriter writer;
+        header.write(writer);
+        auto data = writer.written();
+        out.seekp(0);
+        out.write((const char*)data.data(), data.size());
+    }
+
+    out.close();
+    if (out.fail()) {
+        goto cleanup;
+    }
+
+    {
+        std::error_code ec;
+        std::filesystem::rename(partPath, outputPath, ec);
+        if (ec) {
+            fmt::println("proxy: could not move {} into place: {}", partPath, ec.message());
+            goto cleanup;
+        }
+    }
+
+    success = true;
+    vpf::bumpGeneration();
+    fmt::println("proxy: wrote {} ({} frames, {}x{})", outputPath, header.frameCount, header.width, header.height);
+
+cleanup:
+    if (out.is_open()) out.close();
+    if (!success) {
+        std::error_code ec;
+        std::filesystem::remove(partPath, ec);
+    }
+
+    ZSTD_freeCCtx(cctx);
+    sws_freeContext(sws_ctx);
+    av_packet_free(&pkt);
+    av_frame_free(&scaled);
+    av_frame_free(&frame);
+    avcodec_free_context(&dec_ctx);
+    avformat_close_input(&fmt_ctx);
+
+    return success;
+}
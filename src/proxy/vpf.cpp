@@ -0,0 +1,67 @@
+#include <proxy/vpf.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+
+namespace vpf {
+    void Header::write(qn::HeapByteWriter& writer) const {
+        writer.writeBytes((const uint8_t*)MAGIC, sizeof(MAGIC));
+        writer.writeU16(VERSION);
+        writer.writeU32(width);
+        writer.writeU32(height);
+        writer.writeU32(frameCount);
+        writer.writeU64(indexOffset);
+        writer.writeU32(fpsNum);
+        writer.writeU32(fpsDen);
+        writer.writeU32(sourceWidth);
+        writer.writeU32(sourceHeight);
+    }
+
+    bool Header::read(qn::ByteReader& reader) {
+        char magic[4];
+        if (reader.readBytes((uint8_t*)magic, sizeof(magic)).isErr()) return false;
+        if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+        if (reader.readU16().unwrapOr(0) != VERSION) return false;
+
+        width = reader.readU32().unwrapOr(0);
+        height = reader.readU32().unwrapOr(0);
+        frameCount = reader.readU32().unwrapOr(0);
+        indexOffset = reader.readU64().unwrapOr(0);
+        fpsNum = reader.readU32().unwrapOr(0);
+        fpsDen = reader.readU32().unwrapOr(0);
+        sourceWidth = reader.readU32().unwrapOr(width);
+        sourceHeight = reader.readU32().unwrapOr(height);
+
+        return width > 0 && height > 0 && fpsNum > 0 && fpsDen > 0;
+    }
+
+    size_t Header::getFrameSize() const {
+        size_t chromaW = (width + 1) / 2;
+        size_t chromaH = (height + 1) / 2;
+        return (size_t)width * height + chromaW * chromaH * 2;
+    }
+
+    std::string proxyPathFor(const std::string& source) {
+        return source + ".vpf";
+    }
+
+    bool hasProxy(const std::string& source) {
+        std::error_code ec;
+        auto proxyTime = std::filesystem::last_write_time(proxyPathFor(source), ec);
+        if (ec) return false;
+        auto sourceTime = std::filesystem::last_write_time(source, ec);
+        if (ec) return true;
+        return proxyTime >= sourceTime;
+    }
+
+    static std::atomic<int> generation = 0;
+
+    int getGeneration() {
+        return generation.load(std::memory_order_acquire);
+    }
+
+    void bumpGeneration() {
+        generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
@@ -3,69 +3,70 @@
 
 #include <renderer/audio.hpp>
 
-#define SAMPLE_RATE 48000
-#define CHANNELS 2
-#define FRAME_COUNT 4096
-
-AudioRenderer::AudioRenderer(std::string_view outputPath, float length): outputPath(outputPath), length(length) {
-    ma_encoder_config config = ma_encoder_config_init(ma_encoding_format_wav, ma_format_f32, CHANNELS, SAMPLE_RATE);
-    if (ma_encoder_init_file(this->outputPath.c_str(), &config, &encoder) != MA_SUCCESS) {
-        fmt::println("could not init encoder");
-        return;
-    }
+#include <algorithm>
+#include <cmath>
 
+AudioRenderer::AudioRenderer(float length, float fps): fps(fps) {
+    lengthSamples = std::llround(length * SAMPLE_RATE);
     decoderConfig = ma_decoder_config_init(ma_format_f32, CHANNELS, SAMPLE_RATE);
 }
 
+AudioRenderer::~AudioRenderer() {
+    for (auto& clip : clips) ma_decoder_uninit(&clip->decoder);
+}
+
 void AudioRenderer::addClip(std::string path, float start, float end, std::shared_ptr<NumberProperty> volume) {
-    AudioRenderFile file;
-    ma_decoder_init_file(path.c_str(), &decoderConfig, &file.decoder);
-    file.path = path;
-    file.startTime = start;
-    file.endTime = end;
-    file.volume = volume;
-    clips.push_back(file);
+    auto file = std::make_unique<AudioRenderFile>();
+    if (ma_decoder_init_file(path.c_str(), &decoderConfig, &file->decoder) != MA_SUCCESS) {
+        fmt::println("could not open audio clip {}", path);
+        return;
+    }
+    file->path = path;
+    file->startSample = std::llround(start * SAMPLE_RATE);
+    file->endSample = std::llround(end * SAMPLE_RATE);
+    file->volume = volume;
+    clips.push_back(std::move(file));
 }
 
-void AudioRenderer::render(float fps) {
-    float outBuffer[FRAME_COUNT * CHANNELS];
-    double currentTime = 0.0;
-    double step = (double)FRAME_COUNT / SAMPLE_RATE;
+int AudioRenderer::mix(float* out, int frameCount) {
+    int count = static_cast<int>(std::clamp<int64_t>(lengthSamples - currentSample, 0, frameCount));
+    std::fill(out, out + count * CHANNELS, 0.0f);
+    if (count <= 0) return 0;
 
-    while (currentTime < length) {
-        // fmt::println("current time: {}", currentTime);
-        for (int i = 0; i < FRAME_COUNT * CHANNELS; i++) outBuffer[i] = 0.0f;
+    int64_t blockStart = currentSample;
+    int64_t blockEnd = currentSample + count;
 
-        for (auto clip : clips) {
-            if (currentTime + step < clip.startTime) continue;
-            if (currentTime >= clip.endTime) continue;
-            
-            float temp[FRAME_COUNT * CHANNELS];
-            ma_uint64 framesRead;
-            ma_decoder_read_pcm_frames(&clip.decoder, temp, FRAME_COUNT, &framesRead);
-            
-            double localTime = currentTime - clip.startTime;
-            for (ma_uint64 i = 0; i < framesRead * CHANNELS; i++) {
-                double sampleTime = localTime + (i / (double)CHANNELS / SAMPLE_RATE);
-                int currentFrame = sampleTime * fps;
+    if (scratch.size() < static_cast<size_t>(count * CHANNELS)) {
+        scratch.resize(count * CHANNELS);
+    }
 
-                clip.volume->processKeyframe(currentFrame);
+    for (auto& clip : clips) {
+        // only the part of the block the clip actually covers, so clips start on the exact sample
+        int64_t from = std::max(blockStart, clip->startSample);
+        int64_t to = std::min(blockEnd, clip->endSample);
+        if (from >= to) continue;
 
-                // fmt::println("d {}", vol);
-                outBuffer[i] += temp[i] * clip.volume->data;
-                // fmt::println("{}", outBuffer[i]);
-            }
-        }
+        ma_uint64 framesRead = 0;
+        ma_decoder_read_pcm_frames(&clip->decoder, scratch.data(), to - from, &framesRead);
+
+        float* dst = out + (from - blockStart) * CHANNELS;
+        for (ma_uint64 i = 0; i < framesRead; i++) {
+            double localTime = (double)(from - clip->startSample + (int64_t)i) / SAMPLE_RATE;
+            int currentFrame = localTime * fps;
 
-        for (int i = 0; i < FRAME_COUNT * CHANNELS; i++) {
-            // clamp
-            outBuffer[i] = std::min(std::max(outBuffer[i], -1.0f), 1.0f);
+            clip->volume->processKeyframe(currentFrame);
+
+            for (int ch = 0; ch < CHANNELS; ch++) {
+                dst[i * CHANNELS + ch] += scratch[i * CHANNELS + ch] * clip->volume->data;
+            }
         }
+    }
 
-        ma_encoder_write_pcm_frames(&encoder, outBuffer, FRAME_COUNT, NULL);
-        currentTime += step;
+    for (int i = 0; i < count * CHANNELS; i++) {
+        // clamp
+        out[i] = std::min(std::max(out[i], -1.0f), 1.0f);
     }
 
-    for (auto clip : clips) ma_decoder_uninit(&clip.decoder);
-    ma_encoder_uninit(&encoder);
+    currentSample = blockEnd;
+    return count;
 }
@@ -0,0 +1,224 @@
+#include <renderer/pipeline.hpp>
+
+#include <algorithm>
+#include <map>
+
+#include <fmt/base.h>
+
+// readback buffers past the ones the workers are busy with,
+// so the GPU always has somewhere to write the next frame
+static constexpr int SPARE_READBACKS = 2;
+// AVFrames past one per worker, lets the encoder fall a little behind
+static constexpr int SPARE_FRAMES = 4;
+
+ExportPipeline::ExportPipeline(
+    size_t readbackSize, int workerCount,
+    AVPixelFormat format, int width, int height,
+    ReadbackFn readbackFn, ConvertFn convertFn, EncodeFn encodeFn
+):
+    readbackFn(readbackFn), convertFn(convertFn), encodeFn(encodeFn),
+    convertQueue(std::max(workerCount, 1) + SPARE_READBACKS),
+    encodeQueue(std::max(workerCount, 1) + SPARE_FRAMES + 1),
+    framePool(std::max(workerCount, 1) + SPARE_FRAMES)
+{
+    workerCount = std::max(workerCount, 1);
+
+    ring = std::make_unique<ReadbackRing>(workerCount + SPARE_READBACKS, readbackSize);
+
+    for (int i = 0; i < workerCount + SPARE_FRAMES; i++) {
+        AVFrame* frame = av_frame_alloc();
+        frame->format = format;
+        frame->width = width;
+        frame->height = height;
+        if (av_frame_get_buffer(frame, 0) < 0) {
+            fmt::println("could not allocate export frame");
+            av_frame_free(&frame);
+            failed = true;
+            continue;
+        }
+        frames.push_back(frame);
+        framePool.push(frame);
+    }
+
+    if (failed) return;
+
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+    encoderThread = std::thread([this]() { encoderLoop(); });
+
+    lastSubmit = clock::now();
+}
+
+ExportPipeline::~ExportPipeline() {
+    finish();
+}
+
+int ExportPipeline::defaultWorkerCount() {
+    // the GL and encoder threads need cores too
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    return std::clamp(cores / 2, 1, 4);
+}
+
+bool ExportPipeline::submit(Frame* frame) {
+    if (finished || workers.empty()) return false;
+
+    auto start = clock::now();
+    renderTime += start - lastSubmit;
+
+    releaseDone(false);
+    while (ring->full()) {
+        if (ring->unmapped() > 0) {
+            dispatchOne();
+        } else {
+            releaseDone(true);
+        }
+    }
+
+    readbackFn(frame, *ring, submitted++);
+
+    // hand over anything the GPU already finished without waiting on the rest
+    while (ring->ready()) dispatchOne();
+
+    lastSubmit = clock::now();
+    readbackTime += lastSubmit - start;
+
+    return !failed;
+}
+
+void ExportPipeline::dispatchOne() {
+    if (!ring->ready()) readbackWaits++;
+
+    auto job = std::make_shared<ConvertJob>();
+    job->data = ring->map(&job->frameNum);
+    inFlight.push_back(job);
+
+    if (job->data.empty()) {
+        failed = true;
+    }
+
+    // an empty job still goes through so the encoder doesn't wait on that frame forever
+    convertQueue.push(job);
+}
+
+void ExportPipeline::releaseDone(bool wait) {
+    bool waited = false;
+    while (!inFlight.empty()) {
+        auto& job = inFlight.front();
+        if (!job->done.load(std::memory_order_acquire)) {
+            if (!wait || waited) break;
+            convertStalls++;
+            waited = true;
+            job->done.wait(false, std::memory_order_acquire);
+        }
+        ring->release();
+        inFlight.pop_front();
+    }
+}
+
+void ExportPipeline::workerLoop() {
+    ConvertContext ctx;
+
+    while (true) {
+        // take the frame first, jobs come out in order, so whoever picks up
+        // the oldest job can always finish it and the encoder never deadlocks
+        AVFrame* out = framePool.pop();
+        auto job = convertQueue.pop();
+        if (!job) {
+            framePool.push(out);
+            break;
+        }
+
+        auto start = clock::now();
+        bool valid = !job->data.empty()
+            && av_frame_make_writable(out) >= 0
+            && convertFn(job->data, out, ctx);
+        convertNs += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+
+        // the GL thread unmaps the buffer as soon as this is set
+        int frameNum = job->frameNum;
+        job->done.store(true, std::memory_order_release);
+        job->done.notify_one();
+
+        if (!valid) failed = true;
+        encodeQueue.push({ frameNum, out, valid });
+    }
+
+    sws_freeContext(ctx.sws);
+}
+
+void ExportPipeline::encoderLoop() {
+    // workers finish out of order
+    std::map<int, EncodeJob> pending;
+    int next = 0;
+
+    while (true) {
+        auto job = encodeQueue.pop();
+        if (!job.frame) break;
+
+        pending[job.frameNum] = job;
+        while (!pending.empty() && pending.begin()->first == next) {
+            auto ready = pending.begin()->second;
+            pending.erase(pending.begin());
+
+            if (ready.valid && !failed) {
+                auto start = clock::now();
+                if (!encodeFn(ready.frame)) failed = true;
+                encodeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+            }
+
+            framePool.push(ready.frame);
+            next++;
+        }
+    }
+}
+
+bool ExportPipeline::finish() {
+    if (finished) return !failed;
+    finished = true;
+
+    auto start = clock::now();
+    if (!workers.empty()) {
+        while (ring->unmapped() > 0) dispatchOne();
+
+        for (size_t i = 0; i < workers.size(); i++) convertQueue.push(nullptr);
+        for (auto& worker : workers) worker.join();
+        workers.clear();
+    }
+
+    while (!inFlight.empty()) {
+        ring->release();
+        inFlight.pop_front();
+    }
+
+    if (encoderThread.joinable()) {
+        encodeQueue.push({});
+        encoderThread.join();
+    }
+
+    readbackTime += clock::now() - start;
+
+    for (auto frame : frames) av_frame_free(&frame);
+    frames.clear();
+    ring.reset();
+
+    return !failed;
+}
+
+PipelineStats ExportPipeline::getStats() const {
+    auto seconds = [](auto duration) {
+        return std::chrono::duration<double>(duration).count();
+    };
+
+    return {
+        .frames = submitted,
+        .renderSeconds = seconds(renderTime),
+        .readbackSeconds = seconds(readbackTime),
+        .convertSeconds = convertNs.load() / 1e9,
+        .encodeSeconds = encodeNs.load() / 1e9,
+        .readbackWaits = readbackWaits,
+        .convertStalls = convertStalls,
+        .encodeStalls = framePool.getPopStalls(),
+        .encoderStarved = encodeQueue.getPopStalls()
+    };
+}
@@ -0,0 +1,142 @@
+#include <renderer/settings.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+// first one that's compiled into ffmpeg wins
+static const std::array<std::array<const char*, 2>, 5> ENCODER_NAMES = {{
+    { "libx264", nullptr },
+    { "libx265", nullptr },
+    { "libvpx-vp9", nullptr },
+    { "libsvtav1", "libaom-av1" },
+    { "prores_ks", nullptr },
+}};
+
+// if none of those are there, whatever ffmpeg has for the codec
+static const std::array<AVCodecID, 5> CODEC_IDS = {
+    AV_CODEC_ID_H264,
+    AV_CODEC_ID_HEVC,
+    AV_CODEC_ID_VP9,
+    AV_CODEC_ID_AV1,
+    AV_CODEC_ID_PRORES,
+};
+
+int ExportSettings::maxCRF() const {
+    switch (codec) {
+        case ExportCodec::VP9:
+        case ExportCodec::AV1:
+            return 63;
+        default:
+            return 51;
+    }
+}
+
+AVPixelFormat ExportSettings::getPixelFormat() const {
+    // prores is always 4:2:2 or better
+    if (codec == ExportCodec::ProRes) return AV_PIX_FMT_YUV422P10LE;
+    return AV_PIX_FMT_YUV420P;
+}
+
+const AVCodec* ExportSettings::findEncoder() const {
+    for (auto name : ENCODER_NAMES[(int)codec]) {
+        if (!name) break;
+        if (auto encoder = avcodec_find_encoder_by_name(name)) return encoder;
+    }
+    return avcodec_find_encoder(CODEC_IDS[(int)codec]);
+}
+
+void ExportSettings::apply(AVCodecContext* ctx, AVDictionary** options) const {
+    int speed = (int)preset;
+
+    ctx->pix_fmt = getPixelFormat();
+    ctx->gop_size = keyframeInterval;
+    ctx->max_b_frames = maxBFrames;
+    ctx->thread_count = threads;
+
+    switch (threading) {
+        case EncoderThreading::Auto: break;
+        case EncoderThreading::Frame: ctx->thread_type = FF_THREAD_FRAME; break;
+        case EncoderThreading::Slice: ctx->thread_type = FF_THREAD_SLICE; break;
+    }
+
+    bool useCRF = rateControl == RateControl::CRF;
+    if (!useCRF) {
+        ctx->bit_rate = static_cast<int64_t>(bitrate) * 1000;
+    }
+
+    const char* name = ctx->codec ? ctx->codec->name : "";
+
+    switch (codec) {
+        case ExportCodec::H264:
+        case ExportCodec::HEVC: {
+            av_dict_set(options, "preset", EXPORT_PRESET_NAMES[speed], 0);
+            if (useCRF) av_dict_set_int(options, "crf", crf, 0);
+            break;
+        }
+        case ExportCodec::VP9: {
+            // cpu-used 8 is the fastest, 0 the slowest
+            av_dict_set_int(options, "cpu-used", 8 - speed, 0);
+            av_dict_set(options, "deadline", speed <= (int)ExportPreset::Veryfast ? "realtime" : "good", 0);
+            av_dict_set_int(options, "row-mt", 1, 0);
+            if (useCRF) {
+                av_dict_set_int(options, "crf", crf, 0);
+                // constant quality mode in libvpx needs the bitrate cleared
+                ctx->bit_rate = 0;
+            }
+            break;
+        }
+        case ExportCodec::AV1: {
+            if (std::strcmp(name, "libsvtav1") == 0) {
+                // svt presets go from 0 (slowest) to 13
+                static const int SVT_PRESETS[9] = { 12, 11, 10, 9, 8, 6, 4, 2, 1 };
+                av_dict_set_int(options, "preset", SVT_PRESETS[speed], 0);
+            } else {
+                av_dict_set_int(options, "cpu-used", std::max(8 - speed, 0), 0);
+                av_dict_set_int(options, "row-mt", 1, 0);
+            }
+            if (useCRF) {
+                av_dict_set_int(options, "crf", crf, 0);
+                ctx->bit_rate = 0;
+            }
+            break;
+        }
+        case ExportCodec::ProRes: {
+            // intra only, quality comes from the profile instead of crf
+            ctx->max_b_frames = 0;
+            av_dict_set(options, "profile", "hq", 0);
+            break;
+        }
+    }
+}
+
+bool ExportSettings::parseCodec(const std::string& name, ExportCodec& out) {
+    static const std::array<const char*, 5> ids = { "h264", "hevc", "vp9", "av1", "prores" };
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (name == ids[i]) {
+            out = (ExportCodec)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ExportSettings::parsePreset(const std::string& name, ExportPreset& out) {
+    for (size_t i = 0; i < EXPORT_PRESET_NAMES.size(); i++) {
+        if (name == EXPORT_PRESET_NAMES[i]) {
+            out = (ExportPreset)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ExportSettings::parseThreading(const std::string& name, EncoderThreading& out) {
+    static const std::array<const char*, 3> ids = { "auto", "frame", "slice" };
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (name == ids[i]) {
+            out = (EncoderThreading)i;
+            return true;
+        }
+    }
+    return false;
+}
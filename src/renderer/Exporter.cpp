@@ -0,0 +1,54 @@
+#include <renderer/export.hpp>
+#include <renderer/audio.hpp>
+#include <video.hpp>
+
+#include <chrono>
+
+#include <fmt/base.h>
+#include <fmt/format.h>
+
+Exporter::Exporter(std::shared_ptr<Video> video, std::string outputPath, ExportSettings settings): video(video), outputPath(outputPath), settings(settings) {}
+
+bool Exporter::run() {
+    using clock = std::chrono::steady_clock;
+    auto startTime = clock::now();
+
+    stats = {};
+
+    video->recalculateFrameCount();
+
+    // audio is mixed and encoded as the video goes, straight into the output file
+    auto audio = std::make_shared<AudioRenderer>(video->timeForFrame(video->frameCount), video->getFPS());
+    for (auto track : video->audioTracks) {
+        for (auto& clip : track->getClips()) {
+            audio->addClip(
+                clip->getPath(),
+                video->timeForFrame(clip->startFrame),
+                video->timeForFrame(clip->startFrame + clip->duration),
+                clip->getProperty<NumberProperty>("volume").unwrap()
+            );
+        }
+    }
+
+    VideoRenderer renderer(outputPath, video->getResolution().x, video->getResolution().y, video->getFPS(), settings, audio);
+    if (!renderer.isOk()) {
+        fmt::println("could not start export to {}", outputPath);
+        renderer.finish();
+        return false;
+    }
+
+    auto renderStart = clock::now();
+    video->render(&renderer);
+    bool success = renderer.finish();
+    stats.videoSeconds = std::chrono::duration<double>(clock::now() - renderStart).count();
+    stats.pipeline = renderer.getStats();
+
+    stats.frames = video->frameCount;
+    stats.totalSeconds = std::chrono::duration<double>(clock::now() - startTime).count();
+
+    if (!success) {
+        fmt::println("export to {} failed", outputPath);
+    }
+
+    return success;
+}
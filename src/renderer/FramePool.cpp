@@ -0,0 +1,70 @@
+#include <renderer/pool.hpp>
+
+FramePool& FramePool::get() {
+    // never destroyed, leases held by other singletons can outlive any static here
+    static FramePool* instance = new FramePool();
+    return *instance;
+}
+
+size_t FramePool::sizeOf(const Frame& frame) {
+    return (size_t)frame.textureWidth * frame.textureHeight * 4;
+}
+
+FramePool::Lease FramePool::acquire(int width, int height, float scale) {
+    return acquire(width, height, scale, { 0, 0, Frame::textureSizeFor(width, scale), Frame::textureSizeFor(height, scale) });
+}
+
+FramePool::Lease FramePool::acquire(int width, int height, float scale, PixelRect view) {
+    std::unique_ptr<Frame> frame;
+
+    for (auto it = idle.begin(); it != idle.end(); ++it) {
+        auto& candidate = *it;
+        bool sameLayout = candidate->width == width && candidate->height == height && candidate->scale == scale;
+        bool sameTexture = candidate->textureWidth == view.width && candidate->textureHeight == view.height;
+        if (sameLayout && sameTexture) {
+            frame = std::move(candidate);
+            idle.erase(it);
+            break;
+        }
+    }
+
+    if (frame) {
+        frame->viewX = view.x;
+        frame->viewY = view.y;
+    } else {
+        frame = std::make_unique<Frame>(width, height, scale, view);
+        trim(sizeOf(*frame));
+        usage += sizeOf(*frame);
+        created++;
+    }
+
+    leased++;
+    return Lease(frame.release(), [](Frame* frame) {
+        FramePool::get().release(frame);
+    });
+}
+
+void FramePool::release(Frame* frame) {
+    leased--;
+    idle.emplace_front(frame);
+    trim();
+}
+
+void FramePool::trim(size_t extra) {
+    while (!idle.empty() && usage + extra > budget) {
+        usage -= sizeOf(*idle.back());
+        idle.pop_back();
+    }
+}
+
+void FramePool::setBudget(size_t bytes) {
+    budget = bytes;
+    trim();
+}
+
+void FramePool::clear() {
+    for (auto& frame : idle) {
+        usage -= sizeOf(*frame);
+    }
+    idle.clear();
+}
@@ -0,0 +1,78 @@
+#include <renderer/atlas.hpp>
+#include <renderer/backend.hpp>
+
+#include <cstring>
+
+#include <fmt/base.h>
+
+GlyphAtlas::GlyphAtlas(): height(INITIAL_HEIGHT), pixels(WIDTH * INITIAL_HEIGHT, 0) {
+    texture = texture::create();
+    texture::upload(texture, texture::Format::R8, WIDTH, height, pixels.data());
+}
+
+GlyphAtlas::~GlyphAtlas() {
+    texture::destroy(texture);
+}
+
+bool GlyphAtlas::grow() {
+    if (height >= MAX_HEIGHT) return false;
+
+    // rows are stored top to bottom, so the old contents stay where they were
+    height *= 2;
+    pixels.resize(WIDTH * height, 0);
+    texture::upload(texture, texture::Format::R8, WIDTH, height, pixels.data());
+
+    return true;
+}
+
+std::optional<GlyphAtlas::Region> GlyphAtlas::insert(int width, int height, const uint8_t* bitmap, int pitch) {
+    int paddedW = width + PADDING * 2;
+    int paddedH = height + PADDING * 2;
+    if (paddedW > WIDTH) {
+        fmt::println("glyph atlas: {}x{} glyph is wider than the atlas", width, height);
+        return std::nullopt;
+    }
+
+    // first shelf that's tall enough and still has room, otherwise a new one on top
+    Shelf* shelf = nullptr;
+    for (auto& candidate : shelves) {
+        if (candidate.height >= paddedH && candidate.cursorX + paddedW <= WIDTH) {
+            shelf = &candidate;
+            break;
+        }
+    }
+
+    if (!shelf) {
+        int y = shelves.empty() ? 0 : shelves.back().y + shelves.back().height;
+        while (y + paddedH > this->height) {
+            if (!grow()) {
+                fmt::println("glyph atlas: out of room");
+                return std::nullopt;
+            }
+        }
+        shelf = &shelves.emplace_back(Shelf { .y = y, .height = paddedH, .cursorX = 0 });
+    }
+
+    Region region {
+        .x = shelf->cursorX + PADDING,
+        .y = shelf->y + PADDING,
+        .width = width,
+        .height = height
+    };
+    shelf->cursorX += paddedW;
+
+    if (width == 0 || height == 0) return region;
+
+    for (int row = 0; row < height; row++) {
+        std::memcpy(&pixels[(region.y + row) * WIDTH + region.x], bitmap + row * pitch, width);
+    }
+
+    // upload just the glyph's rows out of the cpu copy
+    texture::update(
+        texture, texture::Format::R8,
+        region.x, region.y, width, height,
+        &pixels[region.y * WIDTH + region.x], WIDTH
+    );
+
+    return region;
+}
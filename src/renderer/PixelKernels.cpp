@@ -0,0 +1,84 @@
+#include <renderer/pixel.hpp>
+
+#include <libyuv.h>
+
+namespace pixel {
+    static libyuv::FilterMode toLibyuv(Filter filter) {
+        switch (filter) {
+            case Filter::Box: return libyuv::kFilterBox;
+            case Filter::Bilinear: return libyuv::kFilterBilinear;
+        }
+        return libyuv::kFilterBilinear;
+    }
+
+    bool rgbaToI420(
+        const uint8_t* rgba, int rgbaStride,
+        uint8_t* y, int yStride, uint8_t* u, int uStride, uint8_t* v, int vStride,
+        int width, int height
+    ) {
+        return libyuv::ABGRToI420(rgba, rgbaStride, y, yStride, u, uStride, v, vStride, width, height) == 0;
+    }
+
+    bool rgbaToNV12(
+        const uint8_t* rgba, int rgbaStride,
+        uint8_t* y, int yStride, uint8_t* uv, int uvStride,
+        int width, int height
+    ) {
+        return libyuv::ABGRToNV12(rgba, rgbaStride, y, yStride, uv, uvStride, width, height) == 0;
+    }
+
+    bool i420ToRGBA(
+        const uint8_t* y, int yStride, const uint8_t* u, int uStride, const uint8_t* v, int vStride,
+        uint8_t* rgba, int rgbaStride,
+        int width, int height
+    ) {
+        return libyuv::I420ToABGR(y, yStride, u, uStride, v, vStride, rgba, rgbaStride, width, height) == 0;
+    }
+
+    bool nv12ToRGBA(
+        const uint8_t* y, int yStride, const uint8_t* uv, int uvStride,
+        uint8_t* rgba, int rgbaStride,
+        int width, int height
+    ) {
+        return libyuv::NV12ToABGR(y, yStride, uv, uvStride, rgba, rgbaStride, width, height) == 0;
+    }
+
+    bool rgbToRGBA(const uint8_t* rgb, int rgbStride, uint8_t* rgba, int rgbaStride, int width, int height) {
+        // libyuv names formats by the order in a little endian word, so RGB24 -> ARGB
+        // (b, g, r -> b, g, r, a in memory) keeps the channels where they are
+        return libyuv::RGB24ToARGB(rgb, rgbStride, rgba, rgbaStride, width, height) == 0;
+    }
+
+    bool scaleRGBA(
+        const uint8_t* src, int srcStride, int srcWidth, int srcHeight,
+        uint8_t* dst, int dstStride, int dstWidth, int dstHeight,
+        Filter filter
+    ) {
+        // channel order doesn't matter to a scale, every byte is filtered the same
+        return libyuv::ARGBScale(
+            src, srcStride, srcWidth, srcHeight,
+            dst, dstStride, dstWidth, dstHeight,
+            toLibyuv(filter)
+        ) == 0;
+    }
+
+    bool scaleI420(
+        const uint8_t* srcY, int srcYStride, const uint8_t* srcU, int srcUStride, const uint8_t* srcV, int srcVStride,
+        int srcWidth, int srcHeight,
+        uint8_t* dstY, int dstYStride, uint8_t* dstU, int dstUStride, uint8_t* dstV, int dstVStride,
+        int dstWidth, int dstHeight,
+        Filter filter
+    ) {
+        return libyuv::I420Scale(
+            srcY, srcYStride, srcU, srcUStride, srcV, srcVStride,
+            srcWidth, srcHeight,
+            dstY, dstYStride, dstU, dstUStride, dstV, dstVStride,
+            dstWidth, dstHeight,
+            toLibyuv(filter)
+        ) == 0;
+    }
+
+    void copyPlane(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride, int width, int height) {
+        libyuv::CopyPlane(src, srcStride, dst, dstStride, width, height);
+    }
+}
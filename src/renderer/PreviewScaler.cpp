@@ -0,0 +1,36 @@
+#include <renderer/preview.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+void PreviewScaler::addSample(double ms, double budgetMs) {
+    samples[sampleCount++] = ms;
+    if (sampleCount < WINDOW) return;
+    sampleCount = 0;
+
+    double average = std::accumulate(samples.begin(), samples.end(), 0.0) / WINDOW;
+
+    // a step up is roughly 4x the pixels, so only go back once there's plenty of headroom
+    if (average > budgetMs * 0.8 && playbackStep < (int)SCALES.size() - 1) {
+        playbackStep++;
+    } else if (average < budgetMs * 0.2 && playbackStep > 0) {
+        playbackStep--;
+    }
+}
+
+float PreviewScaler::getScale(PreviewQuality quality, float displayScale, bool playing) const {
+    if (quality != PreviewQuality::Auto) {
+        return SCALES[(int)quality];
+    }
+
+    // smallest scale that still has at least as many pixels as the player shows
+    int step = 0;
+    while (step + 1 < (int)SCALES.size() && SCALES[step + 1] >= displayScale) {
+        step++;
+    }
+
+    // paused frames are always as sharp as the player can show them
+    if (playing) step = std::max(step, playbackStep);
+
+    return SCALES[step];
+}
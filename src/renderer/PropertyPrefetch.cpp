@@ -0,0 +1,94 @@
+#include <renderer/prefetch.hpp>
+
+#include <video.hpp>
+
+#include <algorithm>
+#include <thread>
+
+PropertyPrefetch::PropertyPrefetch(Video& video): frameCount(video.frameCount) {
+    for (auto& track : video.videoTracks) {
+        for (auto& clip : track->getClips()) {
+            for (auto& [id, property] : clip->m_properties) {
+                // a single keyframe never changes, processKeyframe is cheap enough for those
+                if (property->getKeyframeCount() <= 1) continue;
+
+                property->prepareEvaluation();
+                targets.push_back({ property, clip->startFrame, clip->startFrame + clip->duration });
+            }
+        }
+    }
+
+    // the export pipeline's conversion workers want most of the cores
+    workerCount = std::clamp((int)std::thread::hardware_concurrency() / 4, 1, 4);
+
+    for (auto& block : blocks) {
+        block.samples.resize(targets.size());
+    }
+
+    if (!targets.empty() && frameCount > 0) {
+        launch(blocks[0], 0);
+    }
+}
+
+PropertyPrefetch::~PropertyPrefetch() {
+    for (auto& block : blocks) {
+        wait(block);
+    }
+    for (auto& target : targets) {
+        target.property->samples = nullptr;
+    }
+}
+
+void PropertyPrefetch::launch(Block& block, int startFrame) {
+    block.startFrame = startFrame;
+    block.count = std::min(BLOCK_FRAMES, frameCount - startFrame);
+
+    int jobs = std::min<int>(workerCount, targets.size());
+    for (int job = 0; job < jobs; job++) {
+        block.pending.push_back(std::async(std::launch::async, [this, &block, job, jobs]() {
+            for (size_t i = job; i < targets.size(); i += jobs) {
+                auto& target = targets[i];
+                // only the frames the clip is on screen for, nothing asks about the rest
+                int first = std::max(block.startFrame, target.firstFrame);
+                int last = std::min(block.startFrame + block.count - 1, target.lastFrame);
+                target.property->evaluateRange(first, last - first + 1, block.samples[i]);
+            }
+        }));
+    }
+}
+
+void PropertyPrefetch::wait(Block& block) {
+    for (auto& job : block.pending) {
+        job.get();
+    }
+    block.pending.clear();
+}
+
+void PropertyPrefetch::advance(int frame) {
+    if (targets.empty()) return;
+
+    if (current >= 0) {
+        auto& active = blocks[current];
+        if (frame >= active.startFrame && frame < active.startFrame + active.count) return;
+    }
+
+    int start = frame - frame % BLOCK_FRAMES;
+    int nextIdx = current < 0 ? 0 : 1 - current;
+    auto& next = blocks[nextIdx];
+    wait(next);
+    // frames were skipped, so what's ready isn't what's needed
+    if (next.startFrame != start || next.count <= 0) {
+        launch(next, start);
+        wait(next);
+    }
+
+    for (size_t i = 0; i < targets.size(); i++) {
+        targets[i].property->samples = &next.samples[i];
+    }
+    current = nextIdx;
+
+    // nothing points at the other block anymore, start on what comes after this one
+    if (start + BLOCK_FRAMES < frameCount) {
+        launch(blocks[1 - current], start + BLOCK_FRAMES);
+    }
+}
@@ -0,0 +1,169 @@
+#include <renderer/batch.hpp>
+#include <renderer/backend.hpp>
+#include <renderer/software.hpp>
+
+#include <shaders/shader.hpp>
+#include <shaders/shape.hpp>
+#include <shaders/texture.hpp>
+
+#include <cstddef>
+#include <cstring>
+
+QuadBatch& QuadBatch::get() {
+    static QuadBatch instance;
+    return instance;
+}
+
+void QuadBatch::init() {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * sizeof(Quad), nullptr, GL_STREAM_DRAW);
+
+    // every quad is the same two triangles, so the indices never change
+    std::vector<GLuint> indices(MAX_QUADS * 6);
+    for (GLuint i = 0; i < MAX_QUADS; i++) {
+        GLuint base = i * 4;
+        GLuint quad[6] = { base, base + 1, base + 3, base, base + 2, base + 3 };
+        std::memcpy(&indices[i * 6], quad, sizeof(quad));
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+    constexpr GLsizei stride = sizeof(QuadVertex);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(QuadVertex, x));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(QuadVertex, u));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(QuadVertex, r));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(QuadVertex, shapeType));
+    glEnableVertexAttribArray(3);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void QuadBatch::add(GLuint fbo, int width, int height, Program program, std::array<GLuint, 3> textures, const Quad& quad) {
+    DrawState next {
+        .fbo = fbo,
+        .width = width,
+        .height = height,
+        .program = program,
+        .textures = textures
+    };
+
+    if (!pending.empty() && (next != state || pending.size() >= MAX_QUADS * 4)) {
+        flush();
+    }
+
+    state = next;
+    pending.insert(pending.end(), quad.begin(), quad.end());
+}
+
+void QuadBatch::flush(GLuint fbo) {
+    if (!pending.empty() && state.fbo == fbo) flush();
+}
+
+void QuadBatch::discard(GLuint fbo) {
+    if (state.fbo == fbo) pending.clear();
+}
+
+void QuadBatch::flush() {
+    if (pending.empty()) return;
+
+    int quads = pending.size() / 4;
+
+    if (backend::isSoftware()) {
+        SoftwareRasterizer::get().drawQuads(state.fbo, state.program, state.textures, pending.data(), quads);
+        drawCalls++;
+        quadCount += quads;
+        pending.clear();
+        return;
+    }
+
+    if (!VAO) init();
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+    // orphan the buffer instead of waiting on draws that still read the old contents
+    if (writeOffset + quads > MAX_QUADS) {
+        glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * sizeof(Quad), nullptr, GL_STREAM_DRAW);
+        writeOffset = 0;
+    }
+
+    // nothing queued before writeOffset touches this range, so there's no need to sync
+    void* dst = glMapBufferRange(
+        GL_ARRAY_BUFFER,
+        writeOffset * sizeof(Quad), quads * sizeof(Quad),
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+    );
+    if (dst) {
+        std::memcpy(dst, pending.data(), quads * sizeof(Quad));
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, writeOffset * sizeof(Quad), quads * sizeof(Quad), pending.data());
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, state.fbo);
+    glViewport(0, 0, state.width, state.height);
+
+    // color blends with straight alpha while alpha adds up coverage (src + dst * (1 - src)),
+    // so drawing into a cleared, transparent layer leaves premultiplied color behind
+    glEnable(GL_BLEND);
+    if (state.program == Program::Layer) {
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    } else {
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    switch (state.program) {
+        case Program::Shape: {
+            shader::getProgram(shapeVertex, shapeFragment).use();
+            break;
+        }
+        case Program::Texture: {
+            auto& program = shader::getProgram(textureVertex, textureFragment);
+            program.use();
+            glUniform1i(program.uniform("texture1"), 0);
+            break;
+        }
+        case Program::TextureYUV: {
+            auto& program = shader::getProgram(textureVertex, textureFragmentYUV);
+            program.use();
+            glUniform1i(program.uniform("textureY"), 0);
+            glUniform1i(program.uniform("textureU"), 1);
+            glUniform1i(program.uniform("textureV"), 2);
+            break;
+        }
+        case Program::Layer: {
+            auto& program = shader::getProgram(textureVertex, textureFragmentPremultiplied);
+            program.use();
+            glUniform1i(program.uniform("texture1"), 0);
+            break;
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        if (!state.textures[i]) continue;
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, state.textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+
+    glDrawElementsBaseVertex(GL_TRIANGLES, quads * 6, GL_UNSIGNED_INT, nullptr, writeOffset * 4);
+
+    writeOffset += quads;
+    drawCalls++;
+    quadCount += quads;
+    pending.clear();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,174 @@
+#include <renderer/readback.hpp>
+#include <renderer/backend.hpp>
+#include <renderer/software.hpp>
+#include <frame.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include <fmt/base.h>
+
+ReadbackRing::ReadbackRing(int count, size_t slotSize): slotSize(slotSize) {
+    slots.resize(std::max(count, 1));
+
+    if (backend::isSoftware()) {
+        for (auto& slot : slots) slot.host.resize(slotSize);
+        return;
+    }
+
+    for (auto& slot : slots) {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, slotSize, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+ReadbackRing::~ReadbackRing() {
+    if (backend::isSoftware()) return;
+
+    for (auto& slot : slots) {
+        if (slot.mapped) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        if (slot.fence) glDeleteSync(slot.fence);
+        glDeleteBuffers(1, &slot.pbo);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+bool ReadbackRing::begin(int frameNum) {
+    if (full() || recording) {
+        fmt::println("readback ring is full, map() the oldest frame first");
+        return false;
+    }
+
+    auto& slot = slots[head];
+    slot.frameNum = frameNum;
+    recording = true;
+
+    if (backend::isSoftware()) return true;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    return true;
+}
+
+void ReadbackRing::read(GLuint fbo, int width, int height, GLenum format, size_t offset, GLenum attachment) {
+    if (!recording) return;
+
+    if (backend::isSoftware()) {
+        // there's only ever the one attachment, and frames are already tightly packed rgba
+        auto image = SoftwareRasterizer::get().getImage(fbo);
+        auto& host = slots[head].host;
+        if (!image || format != GL_RGBA || offset >= host.size()) return;
+
+        size_t size = std::min({ (size_t)width * height * 4, image->pixels.size(), host.size() - offset });
+        std::memcpy(host.data() + offset, image->pixels.data(), size);
+        return;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glReadBuffer(attachment);
+    // with a pack buffer bound the pointer is an offset into it,
+    // so this returns right away instead of waiting on the GPU
+    glReadPixels(
+        0, 0,
+        width, height,
+        format,
+        GL_UNSIGNED_BYTE,
+        reinterpret_cast<void*>(offset)
+    );
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+void ReadbackRing::end() {
+    if (!recording) return;
+
+    if (!backend::isSoftware()) {
+        slots[head].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    head = (head + 1) % slots.size();
+    pending++;
+    recording = false;
+}
+
+bool ReadbackRing::queue(Frame* frame, int frameNum) {
+    if (!begin(frameNum)) return false;
+    frame->flush();
+    read(frame->fbo, frame->textureWidth, frame->textureHeight, GL_RGBA);
+    end();
+    return true;
+}
+
+bool ReadbackRing::ready() {
+    if (unmapped() <= 0) return false;
+
+    auto& slot = slots[(tail + handedOut) % slots.size()];
+    if (!slot.fence) return true;
+
+    GLenum res = glClientWaitSync(slot.fence, 0, 0);
+    return res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED;
+}
+
+std::span<const uint8_t> ReadbackRing::map(int* frameNum) {
+    if (unmapped() <= 0) return {};
+
+    auto& slot = slots[(tail + handedOut) % slots.size()];
+    handedOut++;
+    if (frameNum) *frameNum = slot.frameNum;
+
+    if (slot.fence) {
+        // flush on the first wait so the fence is actually submitted
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (true) {
+            GLenum res = glClientWaitSync(slot.fence, flags, 1'000'000'000);
+            if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED) break;
+            if (res == GL_WAIT_FAILED) {
+                fmt::println("waiting on readback fence failed");
+                break;
+            }
+            flags = 0;
+        }
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+
+    if (backend::isSoftware()) return slot.host;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    auto ptr = static_cast<const uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slotSize, GL_MAP_READ_BIT));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (!ptr) {
+        fmt::println("could not map readback buffer");
+        return {};
+    }
+
+    slot.mapped = true;
+    return { ptr, slotSize };
+}
+
+void ReadbackRing::release() {
+    if (empty()) return;
+
+    auto& slot = slots[tail];
+    if (slot.mapped) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.mapped = false;
+    }
+    if (slot.fence) {
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+    if (handedOut > 0) handedOut--;
+
+    tail = (tail + 1) % slots.size();
+    pending--;
+}
@@ -0,0 +1,134 @@
+#include <renderer/backend.hpp>
+#include <renderer/software.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+static RenderBackend current = RenderBackend::OpenGL;
+
+namespace backend {
+    RenderBackend get() {
+        return current;
+    }
+
+    void set(RenderBackend backend) {
+        current = backend;
+    }
+
+    bool parse(const std::string& name, RenderBackend& out) {
+        for (size_t i = 0; i < RENDER_BACKEND_NAMES.size(); i++) {
+            if (name == RENDER_BACKEND_NAMES[i]) {
+                out = (RenderBackend)i;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+namespace texture {
+    static int channelsOf(Format format) {
+        switch (format) {
+            case Format::R8: return 1;
+            case Format::RGB8: return 3;
+            case Format::RGBA8: return 4;
+        }
+        return 4;
+    }
+
+    static GLenum glFormatOf(Format format) {
+        switch (format) {
+            case Format::R8: return GL_RED;
+            case Format::RGB8: return GL_RGB;
+            case Format::RGBA8: return GL_RGBA;
+        }
+        return GL_RGBA;
+    }
+
+    static GLenum glInternalFormatOf(Format format) {
+        switch (format) {
+            case Format::R8: return GL_R8;
+            case Format::RGB8: return GL_RGB8;
+            case Format::RGBA8: return GL_RGBA8;
+        }
+        return GL_RGBA8;
+    }
+
+    GLuint create(Wrap wrap) {
+        if (backend::isSoftware()) {
+            return SoftwareRasterizer::get().createImage(wrap == Wrap::Repeat);
+        }
+
+        GLint glWrap = wrap == Wrap::Repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, glWrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, glWrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+    void upload(GLuint texture, Format format, int width, int height, const uint8_t* data) {
+        if (backend::isSoftware()) {
+            auto image = SoftwareRasterizer::get().getImage(texture);
+            if (!image) return;
+
+            image->width = width;
+            image->height = height;
+            image->channels = channelsOf(format);
+            size_t size = (size_t)width * height * image->channels;
+            image->pixels.resize(size);
+            if (data) {
+                std::memcpy(image->pixels.data(), data, size);
+            } else {
+                std::fill(image->pixels.begin(), image->pixels.end(), 0);
+            }
+            return;
+        }
+
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, glInternalFormatOf(format), width, height, 0, glFormatOf(format), GL_UNSIGNED_BYTE, data);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void update(GLuint texture, Format format, int x, int y, int width, int height, const uint8_t* data, int stride) {
+        if (backend::isSoftware()) {
+            auto image = SoftwareRasterizer::get().getImage(texture);
+            if (!image || image->channels != channelsOf(format)) return;
+            if (x < 0 || y < 0 || x + width > image->width || y + height > image->height) return;
+
+            int channels = image->channels;
+            for (int row = 0; row < height; row++) {
+                std::memcpy(
+                    &image->pixels[((size_t)(y + row) * image->width + x) * channels],
+                    data + (size_t)row * stride * channels,
+                    (size_t)width * channels
+                );
+            }
+            return;
+        }
+
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, glFormatOf(format), GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void destroy(GLuint texture) {
+        if (!texture) return;
+
+        if (backend::isSoftware()) {
+            SoftwareRasterizer::get().destroyImage(texture);
+            return;
+        }
+
+        glDeleteTextures(1, &texture);
+    }
+}
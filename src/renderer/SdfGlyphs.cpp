@@ -0,0 +1,205 @@
+#include <renderer/sdf.hpp>
+
+#include <binary/reader.hpp>
+#include <binary/writer.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include <fmt/base.h>
+#include <fmt/format.h>
+
+#include <freetype/ftmodapi.h>
+
+namespace sdf {
+    // what the cached set was generated from, any mismatch means regenerating
+    struct Source {
+        uint64_t fontSize = 0;
+        int64_t fontTime = 0;
+        uint16_t pixelSize = 0;
+        uint16_t spread = SPREAD;
+
+        bool operator==(const Source& other) const = default;
+    };
+
+    static bool getSource(const std::string& fontPath, int pixelSize, Source& out) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(fontPath, ec);
+        if (ec) return false;
+        auto time = std::filesystem::last_write_time(fontPath, ec);
+        if (ec) return false;
+
+        out.fontSize = size;
+        out.fontTime = time.time_since_epoch().count();
+        out.pixelSize = pixelSize;
+        return true;
+    }
+
+    std::string cachePathFor(const std::string& fontPath) {
+        auto name = std::filesystem::path(fontPath).stem().string();
+        return fmt::format("cache/fonts/{}-{:016x}.sdf", name, std::hash<std::string>()(fontPath));
+    }
+
+    void configure(FT_Library library) {
+        FT_Int spread = SPREAD;
+        FT_Property_Set(library, "sdf", "spread", &spread);
+    }
+
+    bool renderGlyph(FT_Face face, char32_t codepoint, Glyph& out) {
+        if (FT_Load_Char(face, codepoint, FT_LOAD_DEFAULT)) return false;
+
+        auto slot = face->glyph;
+        out.codepoint = codepoint;
+        out.advance = slot->advance.x;
+
+        // blank glyphs (spaces) have no outline to take a distance to
+        if (slot->outline.n_points > 0 && FT_Render_Glyph(slot, FT_RENDER_MODE_SDF)) return false;
+
+        auto& bitmap = slot->bitmap;
+        out.width = bitmap.width;
+        out.height = bitmap.rows;
+        out.bearingX = slot->bitmap_left;
+        out.bearingY = slot->bitmap_top;
+
+        out.bitmap.resize(out.width * out.height);
+        for (int row = 0; row < out.height; row++) {
+            std::memcpy(&out.bitmap[row * out.width], bitmap.buffer + row * bitmap.pitch, out.width);
+        }
+
+        return true;
+    }
+
+    static bool load(const std::string& path, const Source& source, const std::vector<char32_t>& codepoints, std::vector<Glyph>& out) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+
+        std::vector<uint8_t> data(std::istreambuf_iterator<char>(in), {});
+        qn::ByteReader reader(data);
+
+        char magic[4];
+        if (reader.readBytes((uint8_t*)magic, sizeof(magic)).isErr()) return false;
+        if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+        if (reader.readU16().unwrapOr(0) != VERSION) return false;
+
+        Source cached;
+        cached.fontSize = reader.readU64().unwrapOr(0);
+        cached.fontTime = reader.readI64().unwrapOr(0);
+        cached.pixelSize = reader.readU16().unwrapOr(0);
+        cached.spread = reader.readU16().unwrapOr(0);
+        if (cached != source) return false;
+
+        uint32_t count = reader.readU32().unwrapOr(0);
+        if (count != codepoints.size()) return false;
+
+        out.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            auto& glyph = out[i];
+            glyph.codepoint = reader.readU32().unwrapOr(0);
+            glyph.width = reader.readU16().unwrapOr(0);
+            glyph.height = reader.readU16().unwrapOr(0);
+            glyph.bearingX = reader.readI16().unwrapOr(0);
+            glyph.bearingY = reader.readI16().unwrapOr(0);
+            glyph.advance = reader.readI32().unwrapOr(0);
+
+            if (glyph.codepoint != codepoints[i]) return false;
+
+            glyph.bitmap.resize(glyph.width * glyph.height);
+            if (reader.readBytes(glyph.bitmap.data(), glyph.bitmap.size()).isErr()) return false;
+        }
+
+        return true;
+    }
+
+    static void save(const std::string& path, const Source& source, const std::vector<Glyph>& glyphs) {
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        if (ec) {
+            fmt::println("sdf: could not create the font cache directory: {}", ec.message());
+            return;
+        }
+
+        qn::HeapByteWriter writer;
+        writer.writeBytes((const uint8_t*)MAGIC, sizeof(MAGIC));
+        writer.writeU16(VERSION);
+        writer.writeU64(source.fontSize);
+        writer.writeI64(source.fontTime);
+        writer.writeU16(source.pixelSize);
+        writer.writeU16(source.spread);
+
+        writer.writeU32(glyphs.size());
+        for (auto& glyph : glyphs) {
+            writer.writeU32(glyph.codepoint);
+            writer.writeU16(glyph.width);
+            writer.writeU16(glyph.height);
+            writer.writeI16(glyph.bearingX);
+            writer.writeI16(glyph.bearingY);
+            writer.writeI32(glyph.advance);
+            writer.writeBytes(glyph.bitmap);
+        }
+
+        // written next to it first, so a half written cache is never picked up
+        auto partPath = path + ".part";
+        {
+            std::ofstream out(partPath, std::ios::binary | std::ios::trunc);
+            auto data = writer.written();
+            out.write((const char*)data.data(), data.size());
+            if (out.fail()) {
+                fmt::println("sdf: could not write {}", partPath);
+                return;
+            }
+        }
+
+        std::filesystem::rename(partPath, path, ec);
+        if (ec) {
+            fmt::println("sdf: could not move {} into place: {}", partPath, ec.message());
+        }
+    }
+
+    std::vector<Glyph> generate(const std::string& fontPath, int pixelSize, const std::vector<char32_t>& codepoints) {
+        Source source;
+        if (!getSource(fontPath, pixelSize, source)) {
+            fmt::println("sdf: could not stat {}", fontPath);
+            return {};
+        }
+
+        auto cachePath = cachePathFor(fontPath);
+
+        std::vector<Glyph> glyphs;
+        if (load(cachePath, source, codepoints, glyphs)) return glyphs;
+        glyphs.clear();
+
+        // freetype objects aren't thread safe, so this gets its own library
+        FT_Library library;
+        if (FT_Init_FreeType(&library)) {
+            fmt::println("sdf: could not init freetype!");
+            return {};
+        }
+        configure(library);
+
+        FT_Face face;
+        if (FT_New_Face(library, fontPath.c_str(), 0, &face)) {
+            fmt::println("sdf: could not load {}", fontPath);
+            FT_Done_FreeType(library);
+            return {};
+        }
+        FT_Set_Pixel_Sizes(face, 0, pixelSize);
+
+        glyphs.reserve(codepoints.size());
+        for (auto codepoint : codepoints) {
+            Glyph glyph;
+            if (!renderGlyph(face, codepoint, glyph)) {
+                fmt::println("sdf: could not render glyph U+{:04X}", (uint32_t)codepoint);
+                glyph = { .codepoint = codepoint };
+            }
+            glyphs.push_back(std::move(glyph));
+        }
+
+        FT_Done_Face(face);
+        FT_Done_FreeType(library);
+
+        save(cachePath, source, glyphs);
+        return glyphs;
+    }
+}
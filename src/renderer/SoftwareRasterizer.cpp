@@ -0,0 +1,608 @@
+#include <renderer/software.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SOFTWARE_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SOFTWARE_NEON
+#endif
+
+// one rgba pixel as floats in 0 - 1, what every kernel below works in
+struct Pixel {
+#if defined(SOFTWARE_SSE2)
+    __m128 v;
+
+    Pixel(): v(_mm_setzero_ps()) {}
+    Pixel(__m128 v): v(v) {}
+    Pixel(float r, float g, float b, float a): v(_mm_setr_ps(r, g, b, a)) {}
+
+    static Pixel splat(float x) { return _mm_set1_ps(x); }
+
+    Pixel operator+(Pixel other) const { return _mm_add_ps(v, other.v); }
+    Pixel operator-(Pixel other) const { return _mm_sub_ps(v, other.v); }
+    Pixel operator*(Pixel other) const { return _mm_mul_ps(v, other.v); }
+
+    float alpha() const { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))); }
+    Pixel clamped() const { return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.f)); }
+
+    static Pixel load(const uint8_t* rgba) {
+        int32_t word;
+        std::memcpy(&word, rgba, 4);
+        __m128i zero = _mm_setzero_si128();
+        __m128i wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(word), zero), zero);
+        return _mm_mul_ps(_mm_cvtepi32_ps(wide), _mm_set1_ps(1.f / 255.f));
+    }
+
+    void store(uint8_t* rgba) const {
+        // rounds to nearest, same as the conversion to a unorm8 attachment
+        __m128i wide = _mm_cvtps_epi32(_mm_mul_ps(clamped().v, _mm_set1_ps(255.f)));
+        wide = _mm_packs_epi32(wide, wide);
+        int32_t word = _mm_cvtsi128_si32(_mm_packus_epi16(wide, wide));
+        std::memcpy(rgba, &word, 4);
+    }
+#elif defined(SOFTWARE_NEON)
+    float32x4_t v;
+
+    Pixel(): v(vdupq_n_f32(0.f)) {}
+    Pixel(float32x4_t v): v(v) {}
+    Pixel(float r, float g, float b, float a) {
+        const float data[4] = { r, g, b, a };
+        v = vld1q_f32(data);
+    }
+
+    static Pixel splat(float x) { return vdupq_n_f32(x); }
+
+    Pixel operator+(Pixel other) const { return vaddq_f32(v, other.v); }
+    Pixel operator-(Pixel other) const { return vsubq_f32(v, other.v); }
+    Pixel operator*(Pixel other) const { return vmulq_f32(v, other.v); }
+
+    float alpha() const { return vgetq_lane_f32(v, 3); }
+    Pixel clamped() const { return vminq_f32(vmaxq_f32(v, vdupq_n_f32(0.f)), vdupq_n_f32(1.f)); }
+
+    static Pixel load(const uint8_t* rgba) {
+        uint32_t word;
+        std::memcpy(&word, rgba, 4);
+        uint16x8_t wide = vmovl_u8(vcreate_u8(word));
+        return vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(wide))), vdupq_n_f32(1.f / 255.f));
+    }
+
+    void store(uint8_t* rgba) const {
+        float32x4_t scaled = vmlaq_f32(vdupq_n_f32(0.5f), clamped().v, vdupq_n_f32(255.f));
+        uint16x4_t narrow = vmovn_u32(vcvtq_u32_f32(scaled));
+        uint8x8_t bytes = vmovn_u16(vcombine_u16(narrow, narrow));
+        uint32_t word = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+        std::memcpy(rgba, &word, 4);
+    }
+#else
+    float v[4];
+
+    Pixel(): v { 0.f, 0.f, 0.f, 0.f } {}
+    Pixel(float r, float g, float b, float a): v { r, g, b, a } {}
+
+    static Pixel splat(float x) { return { x, x, x, x }; }
+
+    Pixel operator+(Pixel o) const { return { v[0] + o.v[0], v[1] + o.v[1], v[2] + o.v[2], v[3] + o.v[3] }; }
+    Pixel operator-(Pixel o) const { return { v[0] - o.v[0], v[1] - o.v[1], v[2] - o.v[2], v[3] - o.v[3] }; }
+    Pixel operator*(Pixel o) const { return { v[0] * o.v[0], v[1] * o.v[1], v[2] * o.v[2], v[3] * o.v[3] }; }
+
+    float alpha() const { return v[3]; }
+    Pixel clamped() const {
+        Pixel out;
+        for (int i = 0; i < 4; i++) out.v[i] = std::clamp(v[i], 0.f, 1.f);
+        return out;
+    }
+
+    static Pixel load(const uint8_t* rgba) {
+        return { rgba[0] / 255.f, rgba[1] / 255.f, rgba[2] / 255.f, rgba[3] / 255.f };
+    }
+
+    void store(uint8_t* rgba) const {
+        auto c = clamped();
+        for (int i = 0; i < 4; i++) rgba[i] = (uint8_t)(c.v[i] * 255.f + 0.5f);
+    }
+#endif
+
+    static Pixel lerp(Pixel a, Pixel b, float t) { return a + (b - a) * splat(t); }
+
+    // straight alpha in, what the clip blend state (src alpha, 1 - src alpha / one, 1 - src alpha) adds to the target
+    Pixel premultiplied() const {
+        float a = alpha();
+        return *this * Pixel(a, a, a, 1.f);
+    }
+};
+
+// dst = src + dst * (1 - src alpha) for a run of pixels, src already premultiplied
+// covers both blend states QuadBatch uses, see Pixel::premultiplied
+static void blendSpan(uint8_t* dst, const Pixel* src, int count) {
+    const Pixel one = Pixel::splat(1.f);
+    for (int i = 0; i < count; i++) {
+        Pixel s = src[i];
+        Pixel d = Pixel::load(dst + i * 4);
+        (s + d * (one - Pixel::splat(s.alpha()))).store(dst + i * 4);
+    }
+}
+
+static int wrapCoord(int i, int size, bool repeat) {
+    if (repeat) {
+        i %= size;
+        return i < 0 ? i + size : i;
+    }
+    return std::clamp(i, 0, size - 1);
+}
+
+// texel centers, fractions and neighbours for one linear filtered lookup
+struct Taps {
+    int x0, x1, y0, y1;
+    float tx, ty;
+};
+
+static Taps tapsFor(const SoftwareRasterizer::Image& image, float u, float v) {
+    if (!std::isfinite(u)) u = 0.f;
+    if (!std::isfinite(v)) v = 0.f;
+    if (image.repeat) {
+        u -= std::floor(u);
+        v -= std::floor(v);
+    }
+
+    float x = std::clamp(u * image.width - 0.5f, -1.f, (float)image.width);
+    float y = std::clamp(v * image.height - 0.5f, -1.f, (float)image.height);
+    float fx = std::floor(x);
+    float fy = std::floor(y);
+
+    return {
+        .x0 = wrapCoord((int)fx, image.width, image.repeat),
+        .x1 = wrapCoord((int)fx + 1, image.width, image.repeat),
+        .y0 = wrapCoord((int)fy, image.height, image.repeat),
+        .y1 = wrapCoord((int)fy + 1, image.height, image.repeat),
+        .tx = x - fx,
+        .ty = y - fy
+    };
+}
+
+static bool sampleable(const SoftwareRasterizer::Image* image) {
+    return image && image->width > 0 && image->height > 0 && !image->pixels.empty();
+}
+
+static Pixel fetch(const SoftwareRasterizer::Image& image, int x, int y) {
+    const uint8_t* p = &image.pixels[((size_t)y * image.width + x) * image.channels];
+    switch (image.channels) {
+        case 1: return { p[0] / 255.f, 0.f, 0.f, 1.f };
+        case 3: return { p[0] / 255.f, p[1] / 255.f, p[2] / 255.f, 1.f };
+        default: return Pixel::load(p);
+    }
+}
+
+// texture() with GL_LINEAR, unloaded textures read as opaque black like an incomplete one
+static Pixel sample(const SoftwareRasterizer::Image* image, float u, float v) {
+    if (!sampleable(image)) return { 0.f, 0.f, 0.f, 1.f };
+
+    auto taps = tapsFor(*image, u, v);
+    Pixel top = Pixel::lerp(fetch(*image, taps.x0, taps.y0), fetch(*image, taps.x1, taps.y0), taps.tx);
+    Pixel bottom = Pixel::lerp(fetch(*image, taps.x0, taps.y1), fetch(*image, taps.x1, taps.y1), taps.tx);
+    return Pixel::lerp(top, bottom, taps.ty);
+}
+
+// texture().r, for the single channel glyph atlas and yuv planes
+static float sampleRed(const SoftwareRasterizer::Image* image, float u, float v) {
+    if (!sampleable(image)) return 0.f;
+
+    auto taps = tapsFor(*image, u, v);
+    int channels = image->channels;
+    int width = image->width;
+    auto at = [&](int x, int y) {
+        return image->pixels[((size_t)y * width + x) * channels] / 255.f;
+    };
+
+    float top = at(taps.x0, taps.y0) + (at(taps.x1, taps.y0) - at(taps.x0, taps.y0)) * taps.tx;
+    float bottom = at(taps.x0, taps.y1) + (at(taps.x1, taps.y1) - at(taps.x0, taps.y1)) * taps.tx;
+    return top + (bottom - top) * taps.ty;
+}
+
+// a vertex after the viewport transform, attributes divided by w for perspective correct interpolation
+struct WindowVertex {
+    float x, y;
+    float q, uq, vq;
+};
+
+struct Triangle {
+    WindowVertex v[3];
+    float area;
+    // whether a pixel center exactly on edge i (opposite v[i]) belongs to this triangle
+    bool owns[3];
+    float minX, maxX;
+    int minRow, maxRow;
+    // the provoking (last) vertex, where flat attributes come from
+    const QuadVertex* flat;
+};
+
+// twice the signed area of (a, b, p), positive with p to the left of a -> b.
+// worked out from the same end whichever way round the edge comes in,
+// so triangles sharing an edge get exactly opposite values along it
+static float edge(const WindowVertex& a, const WindowVertex& b, float px, float py) {
+    bool swap = b.x < a.x || (b.x == a.x && b.y < a.y);
+    const auto& from = swap ? b : a;
+    const auto& to = swap ? a : b;
+    float value = (to.x - from.x) * (py - from.y) - (to.y - from.y) * (px - from.x);
+    return swap ? -value : value;
+}
+
+// flips for a reversed edge, so exactly one of two neighbours claims pixels on it
+static bool ownsEdge(const WindowVertex& a, const WindowVertex& b) {
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    return dy > 0.f || (dy == 0.f && dx < 0.f);
+}
+
+static bool covers(const Triangle& tri, float px, float py) {
+    const auto& v = tri.v;
+    float e[3] = {
+        edge(v[1], v[2], px, py),
+        edge(v[2], v[0], px, py),
+        edge(v[0], v[1], px, py)
+    };
+    for (int i = 0; i < 3; i++) {
+        if (e[i] < 0.f || (e[i] == 0.f && !tri.owns[i])) return false;
+    }
+    return true;
+}
+
+// perspective correct uv at a pixel center (or anywhere else on the triangle's plane)
+static void interpolate(const Triangle& tri, float px, float py, float& u, float& v) {
+    const auto& t = tri.v;
+    float w0 = edge(t[1], t[2], px, py) / tri.area;
+    float w1 = edge(t[2], t[0], px, py) / tri.area;
+    float w2 = 1.f - w0 - w1;
+
+    float q = w0 * t[0].q + w1 * t[1].q + w2 * t[2].q;
+    u = (w0 * t[0].uq + w1 * t[1].uq + w2 * t[2].uq) / q;
+    v = (w0 * t[0].vq + w1 * t[1].vq + w2 * t[2].vq) / q;
+}
+
+// false if it can't cover anything. anything behind the camera is dropped instead of
+// clipped against the near plane, the perspective camera never puts clips there
+static bool setupTriangle(Triangle& tri, const QuadVertex& a, const QuadVertex& b, const QuadVertex& c, int width, int height) {
+    const QuadVertex* in[3] = { &a, &b, &c };
+    for (int i = 0; i < 3; i++) {
+        float w = in[i]->w;
+        if (!(w > 1e-6f)) return false;
+
+        float q = 1.f / w;
+        tri.v[i] = {
+            .x = (in[i]->x * q * 0.5f + 0.5f) * width,
+            .y = (in[i]->y * q * 0.5f + 0.5f) * height,
+            .q = q,
+            .uq = in[i]->u * q,
+            .vq = in[i]->v * q
+        };
+    }
+
+    tri.area = edge(tri.v[0], tri.v[1], tri.v[2].x, tri.v[2].y);
+    if (tri.area == 0.f || !std::isfinite(tri.area)) return false;
+    // winding doesn't matter, there's no culling
+    if (tri.area < 0.f) {
+        std::swap(tri.v[1], tri.v[2]);
+        tri.area = -tri.area;
+    }
+
+    tri.owns[0] = ownsEdge(tri.v[1], tri.v[2]);
+    tri.owns[1] = ownsEdge(tri.v[2], tri.v[0]);
+    tri.owns[2] = ownsEdge(tri.v[0], tri.v[1]);
+
+    float minY = std::min({ tri.v[0].y, tri.v[1].y, tri.v[2].y });
+    float maxY = std::max({ tri.v[0].y, tri.v[1].y, tri.v[2].y });
+    tri.minX = std::min({ tri.v[0].x, tri.v[1].x, tri.v[2].x });
+    tri.maxX = std::max({ tri.v[0].x, tri.v[1].x, tri.v[2].x });
+
+    // rows whose centers fall inside the bounds
+    tri.minRow = (int)std::ceil(std::clamp(minY, -1.f, height + 1.f) - 0.5f);
+    tri.maxRow = (int)std::floor(std::clamp(maxY, -1.f, height + 1.f) - 0.5f);
+    tri.minRow = std::max(tri.minRow, 0);
+    tri.maxRow = std::min(tri.maxRow, height - 1);
+
+    tri.flat = &c;
+    return tri.minRow <= tri.maxRow;
+}
+
+// first and last pixel of `row` the triangle covers, false if none
+static bool spanFor(const Triangle& tri, int row, int width, int& first, int& last) {
+    float py = row + 0.5f;
+    float lo = tri.minX;
+    float hi = tri.maxX;
+
+    // each edge bounds the row on one side, where it crosses zero
+    const auto& t = tri.v;
+    const WindowVertex* edges[3][2] = { { &t[1], &t[2] }, { &t[2], &t[0] }, { &t[0], &t[1] } };
+    for (auto& [a, b] : edges) {
+        float slope = -(b->y - a->y);
+        float offset = (b->x - a->x) * (py - a->y) + (b->y - a->y) * a->x;
+        if (slope > 0.f) {
+            lo = std::max(lo, -offset / slope);
+        } else if (slope < 0.f) {
+            hi = std::min(hi, -offset / slope);
+        } else if (offset < 0.f) {
+            return false;
+        }
+    }
+
+    first = (int)std::ceil(std::clamp(lo, -1.f, width + 1.f) - 0.5f);
+    last = (int)std::floor(std::clamp(hi, -1.f, width + 1.f) - 0.5f);
+    first = std::max(first, 0);
+    last = std::min(last, width - 1);
+
+    // the crossings are only close, the exact test has the final say on the ends
+    if (first > 0 && first <= last + 1 && covers(tri, first - 0.5f, py)) first--;
+    while (first <= last && !covers(tri, first + 0.5f, py)) first++;
+    if (last < width - 1 && last >= first - 1 && covers(tri, last + 1.5f, py)) last++;
+    while (last >= first && !covers(tri, last + 0.5f, py)) last--;
+
+    return first <= last;
+}
+
+SoftwareRasterizer& SoftwareRasterizer::get() {
+    // never destroyed, the workers are parked on it until the process exits
+    static SoftwareRasterizer* instance = new SoftwareRasterizer();
+    return *instance;
+}
+
+SoftwareRasterizer::SoftwareRasterizer() {
+    // the thread calling in does its share too
+    int count = (int)std::max(1u, std::thread::hardware_concurrency()) - 1;
+    for (int i = 0; i < count; i++) {
+        workers.emplace_back(&SoftwareRasterizer::workerLoop, this);
+    }
+}
+
+void SoftwareRasterizer::workerLoop() {
+    std::unique_lock lock(workMutex);
+    while (true) {
+        workReady.wait(lock, [this] { return job && nextJob < jobCount; });
+
+        int index = nextJob++;
+        auto fn = job;
+        busyWorkers++;
+
+        lock.unlock();
+        (*fn)(index);
+        lock.lock();
+
+        busyWorkers--;
+        if (busyWorkers == 0 && nextJob >= jobCount) workDone.notify_all();
+    }
+}
+
+void SoftwareRasterizer::parallelFor(int count, const std::function<void(int)>& fn) {
+    if (count <= 1 || workers.empty()) {
+        for (int i = 0; i < count; i++) fn(i);
+        return;
+    }
+
+    std::unique_lock lock(workMutex);
+    job = &fn;
+    jobCount = count;
+    nextJob = 0;
+    workReady.notify_all();
+
+    while (nextJob < jobCount) {
+        int index = nextJob++;
+        busyWorkers++;
+
+        lock.unlock();
+        fn(index);
+        lock.lock();
+
+        busyWorkers--;
+    }
+
+    workDone.wait(lock, [this] { return busyWorkers == 0; });
+    job = nullptr;
+}
+
+GLuint SoftwareRasterizer::createImage(bool repeat) {
+    GLuint id = nextId++;
+    images[id].repeat = repeat;
+    return id;
+}
+
+SoftwareRasterizer::Image* SoftwareRasterizer::getImage(GLuint id) {
+    auto it = images.find(id);
+    return it == images.end() ? nullptr : &it->second;
+}
+
+void SoftwareRasterizer::destroyImage(GLuint id) {
+    images.erase(id);
+}
+
+void SoftwareRasterizer::clear(GLuint target, RGBAColor color) {
+    auto image = getImage(target);
+    if (!image || image->channels != 4) return;
+
+    // glClearColor clamps too
+    uint8_t rgba[4] = {
+        (uint8_t)std::clamp(color.r, 0, 255),
+        (uint8_t)std::clamp(color.g, 0, 255),
+        (uint8_t)std::clamp(color.b, 0, 255),
+        (uint8_t)std::clamp(color.a, 0, 255)
+    };
+    uint32_t word;
+    std::memcpy(&word, rgba, 4);
+
+    size_t count = (size_t)image->width * image->height;
+    auto pixels = reinterpret_cast<uint32_t*>(image->pixels.data());
+    std::fill(pixels, pixels + count, word);
+}
+
+static int bandCount(const SoftwareRasterizer::Image& target) {
+    return (target.height + SoftwareRasterizer::TILE_ROWS - 1) / SoftwareRasterizer::TILE_ROWS;
+}
+
+// one band's worth of work: every triangle in order over the band's rows. `shade` gives the
+// premultiplied color at a pixel center (zero where the shader would discard)
+template <typename Shade>
+static std::function<void(int)> rasterizeBands(SoftwareRasterizer::Image& target, const std::vector<Triangle>& triangles, Shade shade) {
+    return [&target, &triangles, shade](int index) {
+        int rowStart = index * SoftwareRasterizer::TILE_ROWS;
+        int rowEnd = std::min(rowStart + SoftwareRasterizer::TILE_ROWS, target.height) - 1;
+
+        thread_local std::vector<Pixel> span;
+        if ((int)span.size() < target.width) span.resize(target.width);
+
+        for (auto& tri : triangles) {
+            int first = std::max(tri.minRow, rowStart);
+            int last = std::min(tri.maxRow, rowEnd);
+
+            for (int row = first; row <= last; row++) {
+                int x0, x1;
+                if (!spanFor(tri, row, target.width, x0, x1)) continue;
+
+                float py = row + 0.5f;
+                for (int x = x0; x <= x1; x++) {
+                    span[x - x0] = shade(tri, x + 0.5f, py);
+                }
+                blendSpan(&target.pixels[((size_t)row * target.width + x0) * 4], span.data(), x1 - x0 + 1);
+            }
+        }
+    };
+}
+
+void SoftwareRasterizer::drawQuads(GLuint target, QuadBatch::Program program, const std::array<GLuint, 3>& textures, const QuadVertex* vertices, int quads) {
+    auto image = getImage(target);
+    if (!image || image->channels != 4 || image->pixels.empty()) return;
+
+    // same split as QuadBatch's index buffer
+    std::vector<Triangle> triangles;
+    triangles.reserve(quads * 2);
+    for (int i = 0; i < quads; i++) {
+        const QuadVertex* quad = vertices + i * 4;
+        Triangle tri;
+        if (setupTriangle(tri, quad[0], quad[1], quad[3], image->width, image->height)) triangles.push_back(tri);
+        if (setupTriangle(tri, quad[0], quad[2], quad[3], image->width, image->height)) triangles.push_back(tri);
+    }
+    if (triangles.empty()) return;
+
+    const Image* sources[3];
+    for (int i = 0; i < 3; i++) {
+        sources[i] = textures[i] ? getImage(textures[i]) : nullptr;
+    }
+
+    auto run = [&](auto shade) {
+        parallelFor(bandCount(*image), rasterizeBands(*image, triangles, shade));
+    };
+
+    switch (program) {
+        // shapeFragment
+        case QuadBatch::Program::Shape: {
+            run([](const Triangle& tri, float px, float py) {
+                auto flat = tri.flat;
+                if ((int)flat->shapeType == 1) {
+                    float dx = px - flat->centerX;
+                    float dy = py - flat->centerY;
+                    if (std::sqrt(dx * dx + dy * dy) > flat->radius) return Pixel();
+                }
+                return Pixel(flat->r, flat->g, flat->b, flat->a).clamped().premultiplied();
+            });
+            break;
+        }
+        // textureFragment
+        case QuadBatch::Program::Texture: {
+            auto texture = sources[0];
+            run([texture](const Triangle& tri, float px, float py) {
+                float u, v;
+                interpolate(tri, px, py, u, v);
+                Pixel color = sample(texture, u, v);
+                // rgb from the texture, alpha from the opacity
+                color = color * Pixel(1.f, 1.f, 1.f, 0.f) + Pixel(0.f, 0.f, 0.f, tri.flat->a);
+                return color.clamped().premultiplied();
+            });
+            break;
+        }
+        // textureFragmentYUV
+        case QuadBatch::Program::TextureYUV: {
+            auto planeY = sources[0];
+            auto planeU = sources[1];
+            auto planeV = sources[2];
+            run([planeY, planeU, planeV](const Triangle& tri, float px, float py) {
+                float u, v;
+                interpolate(tri, px, py, u, v);
+
+                float y = sampleRed(planeY, u, v);
+                float cb = sampleRed(planeU, u, v) - 0.5f;
+                float cr = sampleRed(planeV, u, v) - 0.5f;
+
+                const Pixel fromU(0.f, -0.344146f, 1.772f, 0.f);
+                const Pixel fromV(1.402f, -0.714136f, 0.f, 0.f);
+                Pixel color = Pixel(y, y, y, tri.flat->a) + fromU * Pixel::splat(cb) + fromV * Pixel::splat(cr);
+                return color.clamped().premultiplied();
+            });
+            break;
+        }
+        // textureFragmentPremultiplied
+        case QuadBatch::Program::Layer: {
+            auto layer = sources[0];
+            run([layer](const Triangle& tri, float px, float py) {
+                float u, v;
+                interpolate(tri, px, py, u, v);
+                return (sample(layer, u, v) * Pixel::splat(tri.flat->a)).clamped();
+            });
+            break;
+        }
+    }
+}
+
+void SoftwareRasterizer::drawText(GLuint target, GLuint atlas, bool sdf, RGBAColor color, const glm::mat4& matrix, const float* vertices, int vertexCount) {
+    auto image = getImage(target);
+    if (!image || image->channels != 4 || image->pixels.empty()) return;
+
+    // textVertex, done up front so the triangles can point at them
+    std::vector<QuadVertex> transformed(vertexCount);
+    for (int i = 0; i < vertexCount; i++) {
+        const float* in = vertices + i * 4;
+        glm::vec4 pos = matrix * glm::vec4(in[0], in[1], 0.f, 1.f);
+        transformed[i] = {
+            pos.x, pos.y, pos.z, pos.w,
+            in[2], in[3],
+            color.r / 255.f, color.g / 255.f, color.b / 255.f, color.a / 255.f
+        };
+    }
+
+    std::vector<Triangle> triangles;
+    triangles.reserve(vertexCount / 3);
+    for (int i = 0; i + 2 < vertexCount; i += 3) {
+        Triangle tri;
+        if (setupTriangle(tri, transformed[i], transformed[i + 1], transformed[i + 2], image->width, image->height)) {
+            triangles.push_back(tri);
+        }
+    }
+    if (triangles.empty()) return;
+
+    const Image* glyphs = getImage(atlas);
+
+    // textFragment
+    parallelFor(bandCount(*image), rasterizeBands(*image, triangles, [glyphs, sdf](const Triangle& tri, float px, float py) {
+        float u, v;
+        interpolate(tri, px, py, u, v);
+        float value = sampleRed(glyphs, u, v);
+
+        float alpha = value;
+        if (sdf) {
+            // fwidth() from the neighbouring pixel centers
+            float ux, vx, uy, vy;
+            interpolate(tri, px + 1.f, py, ux, vx);
+            interpolate(tri, px, py + 1.f, uy, vy);
+            float dx = sampleRed(glyphs, ux, vx) - value;
+            float dy = sampleRed(glyphs, uy, vy) - value;
+            float width = std::max(std::abs(dx) + std::abs(dy), 0.0001f);
+
+            // smoothstep(0.5 - width, 0.5 + width, value)
+            float t = std::clamp((value - (0.5f - width)) / (2.f * width), 0.f, 1.f);
+            alpha = t * t * (3.f - 2.f * t);
+        }
+
+        auto flat = tri.flat;
+        return Pixel(flat->r, flat->g, flat->b, flat->a * alpha).clamped().premultiplied();
+    }));
+}
@@ -1,31 +1,61 @@
 #include <fmt/base.h>
 #include <fmt/format.h>
 
+#include <chrono>
+#include <cmath>
+#include <string_view>
+
 #include <renderer/text.hpp>
+#include <renderer/backend.hpp>
+#include <renderer/software.hpp>
 #include <frame.hpp>
+#include <state.hpp>
 
 #include <shaders/shader.hpp>
 #include <shaders/text.hpp>
 
 TextRenderer::TextRenderer() {
-    textShaderProgram = shader::createProgram(textVertex, textFragment);
-
     if (FT_Init_FreeType(&ft)) {
         fmt::println("could not init freetype!");
     }
+    sdf::configure(ft);
+}
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
+TextRenderer::~TextRenderer() {
+    for (auto& [name, font] : fonts) {
+        // the generator opens the font on its own, but it shouldn't outlive us
+        if (font.pendingSdf.valid()) font.pendingSdf.wait();
+        if (font.face) FT_Done_Face(font.face);
+    }
+    FT_Done_FreeType(ft);
+}
 
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-    glEnableVertexAttribArray(0);
-    
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+// one codepoint out of utf-8, malformed sequences come out as U+FFFD
+static char32_t nextCodepoint(std::string_view text, size_t& i) {
+    unsigned char lead = text[i++];
+    if (lead < 0x80) return lead;
+
+    int extra;
+    char32_t codepoint;
+    if ((lead & 0xE0) == 0xC0) {
+        extra = 1;
+        codepoint = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        extra = 2;
+        codepoint = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        extra = 3;
+        codepoint = lead & 0x07;
+    } else {
+        return 0xFFFD;
+    }
+
+    for (int j = 0; j < extra; j++) {
+        if (i >= text.size() || (text[i] & 0xC0) != 0x80) return 0xFFFD;
+        codepoint = (codepoint << 6) | (text[i++] & 0x3F);
+    }
+
+    return codepoint;
 }
 
 void TextRenderer::loadFont(std::string fontName) {
@@ -37,63 +67,126 @@ void TextRenderer::loadFont(std::string fontName) {
 
     FT_Set_Pixel_Sizes(face, 0, LOAD_SIZE);
 
-    // load font into memory
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 0);
+    auto& font = fonts[fontName];
+    font.face = face;
+    font.ascent = face->size->metrics.ascender;
+    font.lineHeight = face->size->metrics.height >> 6; // >> 6 = convert to pixels
+    font.atlas = std::make_unique<GlyphAtlas>();
+
+    // printable ascii up front, everything else the first time it's drawn
+    std::vector<char32_t> codepoints;
+    for (char32_t c = 32; c < 127; c++) {
+        getCharacter(font, c);
+        codepoints.push_back(c);
+    }
+
+    // the distance fields take a while (or come off disk), draw with the bitmaps meanwhile
+    font.pendingSdf = std::async(std::launch::async, sdf::generate, fontName, (int)LOAD_SIZE, std::move(codepoints));
+}
 
-    fonts[fontName] = {};
+void TextRenderer::pollSdf(Font& font) {
+    if (!font.pendingSdf.valid()) return;
 
-    for (unsigned char c = 0; c < 128; c++) {
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
-            fmt::println("could not load glyph: {}", c);
-            continue;
+    // the editor swaps whenever they're done, but an export waits for them so every
+    // frame is drawn with the same glyphs no matter how long they took
+    if (State::get().isExporting) {
+        font.pendingSdf.wait();
+    } else if (font.pendingSdf.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+
+    auto glyphs = font.pendingSdf.get();
+    if (glyphs.empty()) return;
+
+    // same load size, so all the metrics carry over and only the bitmaps change
+    font.atlas = std::make_unique<GlyphAtlas>();
+    font.characters.clear();
+    font.sdf = true;
+    font.generation++;
+
+    for (auto& glyph : glyphs) {
+        auto& character = font.characters[glyph.codepoint];
+        character = {
+            .size = { 0, 0 },
+            .bearing = { glyph.bearingX, glyph.bearingY },
+            .advance = glyph.advance
+        };
+
+        auto region = font.atlas->insert(glyph.width, glyph.height, glyph.bitmap.data(), glyph.width);
+        if (region) {
+            character.region = *region;
+            character.size = { region->width, region->height };
         }
+    }
+}
 
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
+Font* TextRenderer::getFont(const std::string& fontName) {
+    if (!fonts.contains(fontName)) {
+        loadFont(fontName);
+    }
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    auto it = fonts.find(fontName);
+    if (it == fonts.end()) return nullptr;
 
-        fonts[fontName].characters[c] = Character {
-            .texture = texture,
-            .size = { static_cast<int>(face->glyph->bitmap.width), static_cast<int>(face->glyph->bitmap.rows) },
-            .bearing = { face->glyph->bitmap_left, face->glyph->bitmap_top },
-            .advance = face->glyph->advance.x
-        };
+    pollSdf(it->second);
+    return &it->second;
+}
+
+const Character& TextRenderer::getCharacter(Font& font, char32_t codepoint) {
+    if (auto it = font.characters.find(codepoint); it != font.characters.end()) {
+        return it->second;
     }
 
-    fonts[fontName].ascent = face->size->metrics.ascender;
-    fonts[fontName].lineHeight = face->size->metrics.height >> 6; // >> 6 = convert to pixels
+    auto& character = font.characters[codepoint];
+    character = {};
+
+    if (font.sdf) {
+        sdf::Glyph glyph;
+        if (!sdf::renderGlyph(font.face, codepoint, glyph)) {
+            fmt::println("could not load glyph: U+{:04X}", (uint32_t)codepoint);
+            return character;
+        }
+
+        character.advance = glyph.advance;
+        character.bearing = { glyph.bearingX, glyph.bearingY };
 
-    FT_Done_Face(face);
+        auto region = font.atlas->insert(glyph.width, glyph.height, glyph.bitmap.data(), glyph.width);
+        if (region) {
+            character.region = *region;
+            character.size = { region->width, region->height };
+        }
+        return character;
+    }
+
+    if (FT_Load_Char(font.face, codepoint, FT_LOAD_RENDER)) {
+        fmt::println("could not load glyph: U+{:04X}", (uint32_t)codepoint);
+        return character;
+    }
+
+    auto glyph = font.face->glyph;
+    character.advance = glyph->advance.x;
+    character.bearing = { glyph->bitmap_left, glyph->bitmap_top };
+
+    auto region = font.atlas->insert(glyph->bitmap.width, glyph->bitmap.rows, glyph->bitmap.buffer, glyph->bitmap.pitch);
+    if (region) {
+        character.region = *region;
+        character.size = { region->width, region->height };
+    }
+
+    return character;
 }
 
 Vector2DF TextRenderer::getTextSize(std::string text, std::string fontName, float scale) {
-    if (!fonts.contains(fontName)) {
-        loadFont(fontName);
-    }
+    auto font = getFont(fontName);
+    if (!font) return { 0.f, 0.f };
 
-    auto font = fonts[fontName];
-    float lineHeight = font.lineHeight * scale;
+    float lineHeight = font->lineHeight * scale;
     float maxWidth = 0.f;
     float currentWidth = 0.f;
     int lineCount = 1;
 
-    for (char c : text) {
+    for (size_t i = 0; i < text.size();) {
+        char32_t c = nextCodepoint(text, i);
         if (c == '\n') {
             maxWidth = std::max(maxWidth, currentWidth);
             currentWidth = 0.f;
@@ -101,7 +194,7 @@ Vector2DF TextRenderer::getTextSize(std::string text, std::string fontName, floa
             continue;
         }
 
-        auto character = font.characters[c];
+        auto& character = getCharacter(*font, c);
         currentWidth += (character.advance >> 6) * scale;
     }
 
@@ -111,66 +204,58 @@ Vector2DF TextRenderer::getTextSize(std::string text, std::string fontName, floa
     return { maxWidth, height };
 }
 
-Vector2DF TextRenderer::drawText(Frame* frame, std::string text, std::string fontName, Transform transform, RGBAColor color, float pixelHeight) {
-    if (!fonts.contains(fontName)) {
-        loadFont(fontName);
-    }
-
-    float scale = pixelHeight / LOAD_SIZE;
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, frame->fbo);
-
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+TextLayout::~TextLayout() {
+    if (VBO) glDeleteBuffers(1, &VBO);
+    if (VAO) glDeleteVertexArrays(1, &VAO);
+}
 
-    auto size = getTextSize(text, fontName, scale);
-    // glm::mat4 projection = glm::ortho(0.f, (float)frame->width, 0.f, (float)frame->height, -1.f, 1.f);
-    glm::mat4 matrix = frame->createBaseMatrix(transform.anchorPoint);
-    glm::mat4 flipY = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, -1.0f, 1.0f));
+std::shared_ptr<TextLayout> TextRenderer::layoutText(const std::string& text, const std::string& fontName, float pixelHeight) {
+    auto font = getFont(fontName);
+    if (!font) return nullptr;
 
-    glUseProgram(textShaderProgram);
-    glUniform4f(
-        glGetUniformLocation(textShaderProgram, "textColor"),
-        color.r / 255.f, color.g / 255.f, color.b / 255.f, color.a / 255.f
-    );
-    auto projectionLoc = glGetUniformLocation(textShaderProgram, "projection");
-    glm::mat4 model = frame->createModelFromTransform(transform, { .x = transform.position.x - (int)size.x, .y = -transform.position.y }, size, true);
-    glm::mat4 finalMatrix = matrix * flipY * model;
+    float scale = pixelHeight / LOAD_SIZE;
 
-    glUniformMatrix4fv(
-        projectionLoc,
-        1, GL_FALSE, glm::value_ptr(finalMatrix)
-    );
+    // decode and pull every glyph in first, inserting can grow the atlas
+    // and that would throw off uvs worked out before it
+    std::vector<char32_t> codepoints;
+    codepoints.reserve(text.size());
+    for (size_t i = 0; i < text.size();) {
+        char32_t codepoint = nextCodepoint(text, i);
+        if (codepoint != '\n') getCharacter(*font, codepoint);
+        codepoints.push_back(codepoint);
+    }
 
-    glUniform1i(
-        glGetUniformLocation(textShaderProgram, "text"),
-        0
-    );
+    auto layout = std::make_shared<TextLayout>();
+    layout->font = font;
+    layout->fontGeneration = font->generation;
+    layout->atlasHeight = font->atlas->getHeight();
 
     float cursorX = 0;
     float baseline = 0;
     float maxCursorX = cursorX;
+    float ascent = font->ascent >> 6;
 
-    Font font = fonts[fontName];
+    // the bounding box is measured without rounding the advances, same as getTextSize
+    float currentWidth = 0.f;
+    float maxWidth = 0.f;
 
     int lines = 1;
 
-    fmt::println("--------");
-    for (char character : text) {
-        if (character == '\n') {
-            baseline += font.lineHeight * scale;
+    Vector2DF inkMin = { INFINITY, INFINITY };
+    Vector2DF inkMax = { -INFINITY, -INFINITY };
+
+    vertices.clear();
+    for (char32_t codepoint : codepoints) {
+        if (codepoint == '\n') {
+            baseline += font->lineHeight * scale;
             cursorX = 0;
+            maxWidth = std::max(maxWidth, currentWidth);
+            currentWidth = 0.f;
             lines++;
             continue;
         }
 
-        Character ch = font.characters[character];
-        
-        float ascent = font.ascent >> 6;
+        auto& ch = getCharacter(*font, codepoint);
 
         float xPos = cursorX + ch.bearing.x * scale;
         float yPos = baseline + (ascent - ch.bearing.y) * scale;
@@ -178,37 +263,143 @@ Vector2DF TextRenderer::drawText(Frame* frame, std::string text, std::string fon
         float w = ch.size.x * scale;
         float h = ch.size.y * scale;
 
-        // little debugging thing
-        fmt::println("x: {}, y: {}, w: {}, h: {}, cursor: {}, char: {}", xPos, yPos, w, h, cursorX, character);
-
-        float vertices[6][4] = {
-            { xPos,     yPos + h,   0.0f, 1.0f },            
-            { xPos,     yPos,       0.0f, 0.0f },
-            { xPos + w, yPos,       1.0f, 0.0f },
-
-            { xPos,     yPos + h,   0.0f, 1.0f },
-            { xPos + w, yPos,       1.0f, 0.0f },
-            { xPos + w, yPos + h,   1.0f, 1.0f }           
-        };
+        if (w > 0 && h > 0) {
+            float u0 = ch.region.x / (float)font->atlas->getWidth();
+            float u1 = (ch.region.x + ch.region.width) / (float)font->atlas->getWidth();
+            float v0 = ch.region.y / (float)font->atlas->getHeight();
+            float v1 = (ch.region.y + ch.region.height) / (float)font->atlas->getHeight();
 
-        glActiveTexture(GL_TEXTURE0);
+            vertices.insert(vertices.end(), {
+                xPos,     yPos + h,   u0, v1,
+                xPos,     yPos,       u0, v0,
+                xPos + w, yPos,       u1, v0,
 
-        glBindTexture(GL_TEXTURE_2D, ch.texture);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+                xPos,     yPos + h,   u0, v1,
+                xPos + w, yPos,       u1, v0,
+                xPos + w, yPos + h,   u1, v1
+            });
 
-        // frame->drawTexture(ch.texture, { (int)xPos, (int)yPos }, { (int)w, (int)h });
+            inkMin = { std::min(inkMin.x, xPos), std::min(inkMin.y, yPos) };
+            inkMax = { std::max(inkMax.x, xPos + w), std::max(inkMax.y, yPos + h) };
+        }
 
         cursorX += (int)((ch.advance >> 6) * scale);
+        currentWidth += (ch.advance >> 6) * scale;
 
         if (cursorX > maxCursorX) {
             maxCursorX = cursorX;
         }
     }
 
+    maxWidth = std::max(maxWidth, currentWidth);
+
+    layout->size = { maxWidth, lines * font->lineHeight * scale };
+    layout->maxCursorX = maxCursorX;
+    layout->lines = lines;
+    layout->vertexCount = vertices.size() / 4;
+
+    if (layout->vertexCount == 0) return layout;
+    layout->inkMin = inkMin;
+    layout->inkMax = inkMax;
+
+    if (backend::isSoftware()) {
+        layout->vertices = vertices;
+        return layout;
+    }
+
+    // uploaded once, every frame after this only sets uniforms
+    glGenVertexArrays(1, &layout->VAO);
+    glGenBuffers(1, &layout->VBO);
+
+    glBindVertexArray(layout->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, layout->VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    glEnableVertexAttribArray(0);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return layout;
+}
+
+bool TextRenderer::isCurrent(const TextLayout& layout) {
+    auto font = layout.font;
+    pollSdf(*font);
+    return font->generation == layout.fontGeneration && font->atlas->getHeight() == layout.atlasHeight;
+}
+
+Vector2DF TextRenderer::drawLayout(Frame* frame, const TextLayout& layout, Transform transform, RGBAColor color) {
+    Vector2DF result = { layout.maxCursorX - transform.position.x, layout.size.y };
+    if (layout.vertexCount == 0) return result;
+
+    auto size = layout.size;
+    glm::mat4 matrix = frame->createBaseMatrix(transform.anchorPoint);
+    glm::mat4 flipY = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, -1.0f, 1.0f));
+    glm::mat4 model = frame->createModelFromTransform(transform, { .x = transform.position.x - (int)size.x, .y = -transform.position.y }, size, true);
+    glm::mat4 finalMatrix = matrix * flipY * model;
+
+    if (frame->isMeasuring()) {
+        frame->measure(finalMatrix, layout.inkMin, layout.inkMax);
+        return result;
+    }
+
+    // text is drawn straight into the frame, so whatever was queued before it has to land first
+    frame->flush();
+
+    if (backend::isSoftware()) {
+        SoftwareRasterizer::get().drawText(
+            frame->fbo, layout.font->atlas->getTexture(), layout.font->sdf,
+            color, finalMatrix, layout.vertices.data(), layout.vertexCount
+        );
+        return result;
+    }
+
+    glBindVertexArray(layout.VAO);
+    glBindFramebuffer(GL_FRAMEBUFFER, frame->fbo);
+    glViewport(0, 0, frame->textureWidth, frame->textureHeight);
+
+    // same as QuadBatch, keeps alpha right when drawing into a transparent layer
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    auto& program = shader::getProgram(textVertex, textFragment);
+    program.use();
+    glUniform4f(
+        program.uniform("textColor"),
+        color.r / 255.f, color.g / 255.f, color.b / 255.f, color.a / 255.f
+    );
+
+    glUniformMatrix4fv(
+        program.uniform("projection"),
+        1, GL_FALSE, glm::value_ptr(finalMatrix)
+    );
+
+    glUniform1i(
+        program.uniform("text"),
+        0
+    );
+    glUniform1i(
+        program.uniform("sdf"),
+        layout.font->sdf
+    );
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, layout.font->atlas->getTexture());
+
+    // the whole run in one go
+    glDrawArrays(GL_TRIANGLES, 0, layout.vertexCount);
+
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    return { maxCursorX - transform.position.x, font.lineHeight * scale * lines };
+    return result;
+}
+
+Vector2DF TextRenderer::drawText(Frame* frame, std::string text, std::string fontName, Transform transform, RGBAColor color, float pixelHeight) {
+    auto layout = layoutText(text, fontName, pixelHeight);
+    if (!layout) return { 0.f, 0.f };
+
+    return drawLayout(frame, *layout, transform, color);
 }
@@ -1,7 +1,10 @@
 #include <video.hpp>
+#include <renderer/backend.hpp>
+#include <renderer/pixel.hpp>
+#include <cstring>
 #include <iostream>
 
-VideoRenderer::VideoRenderer(std::string filename, int width, int height, int fps): width(width), height(height), fps(fps), filename(filename) {
+VideoRenderer::VideoRenderer(std::string filename, int width, int height, int fps, ExportSettings settings, std::shared_ptr<AudioRenderer> audio): width(width), height(height), fps(fps), filename(filename), settings(settings), audio(audio) {
     // a bunch of ffmpeg boilerplate
     avformat_network_init();
 
@@ -11,28 +14,41 @@ VideoRenderer::VideoRenderer(std::string filename, int width, int height, int fp
         return;
     }
 
-    codec = avcodec_find_encoder(AV_CODEC_ID_H264);
+    codec = settings.findEncoder();
     if (!codec) {
-        std::cerr << "H.264 codec not found\n";
+        std::cerr << EXPORT_CODEC_NAMES[(int)settings.codec] << " encoder not found\n";
         return;
     }
+    std::cout << "Encoding " << EXPORT_CODEC_NAMES[(int)settings.codec] << " with " << codec->name << "\n";
+
+    if (avformat_query_codec(fmt_ctx->oformat, codec->id, FF_COMPLIANCE_NORMAL) != 1) {
+        std::cerr << "Warning: " << fmt_ctx->oformat->name << " may not support " << codec->name << "\n";
+    }
 
     stream = avformat_new_stream(fmt_ctx, nullptr);
 
     codec_ctx = avcodec_alloc_context3(codec);
-    codec_ctx->codec_id = AV_CODEC_ID_H264;
     codec_ctx->width = width;
     codec_ctx->height = height;
     codec_ctx->time_base = AVRational{1, fps};
     codec_ctx->framerate = AVRational{fps, 1};
-    codec_ctx->pix_fmt = AV_PIX_FMT_YUV420P;
-    codec_ctx->gop_size = 12;
-    codec_ctx->max_b_frames = 2;
+
+    AVDictionary* options = nullptr;
+    settings.apply(codec_ctx, &options);
 
     if (fmt_ctx->oformat->flags & AVFMT_GLOBALHEADER)
         codec_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
-    if (avcodec_open2(codec_ctx, codec, nullptr) < 0) {
+    int ret = avcodec_open2(codec_ctx, codec, &options);
+
+    // anything left over wasn't understood by this encoder
+    const AVDictionaryEntry* unused = nullptr;
+    while ((unused = av_dict_iterate(options, unused))) {
+        std::cerr << codec->name << " ignored option " << unused->key << "=" << unused->value << "\n";
+    }
+    av_dict_free(&options);
+
+    if (ret < 0) {
         std::cerr << "Could not open codec\n";
         return;
     }
@@ -40,6 +56,9 @@ VideoRenderer::VideoRenderer(std::string filename, int width, int height, int fp
     avcodec_parameters_from_context(stream->codecpar, codec_ctx);
     stream->time_base = codec_ctx->time_base;
 
+    // every stream has to exist before the header is written
+    if (audio && !openAudio()) return;
+
     if (!(fmt_ctx->oformat->flags & AVFMT_NOFILE)) {
         if (avio_open(&fmt_ctx->pb, filename.c_str(), AVIO_FLAG_WRITE) < 0) {
             std::cerr << "Could not open output file\n";
@@ -52,131 +71,290 @@ VideoRenderer::VideoRenderer(std::string filename, int width, int height, int fp
         return;
     }
 
-    frame = av_frame_alloc();
-    frame->format = codec_ctx->pix_fmt;
-    frame->width  = width;
-    frame->height = height;
-    av_frame_get_buffer(frame, 0);
+    // the yuv converter is a shader, software frames go through sws on the workers instead
+    if (codec_ctx->pix_fmt == AV_PIX_FMT_YUV420P && !backend::isSoftware()) {
+        yuv = std::make_unique<YUVConverter>(width, height);
+        if (!yuv->isOk()) yuv.reset();
+    }
 
-    sws_ctx = sws_getContext(
-        width, height, AV_PIX_FMT_RGBA,
-        width, height, AV_PIX_FMT_YUV420P,
-        SWS_BILINEAR, nullptr, nullptr, nullptr
+    size_t readbackSize = yuv ? yuv->getBufferSize() : static_cast<size_t>(width) * height * 4;
+
+    pipeline = std::make_unique<ExportPipeline>(
+        readbackSize, ExportPipeline::defaultWorkerCount(),
+        codec_ctx->pix_fmt, width, height,
+        [this](Frame* vidFrame, ReadbackRing& ring, int frameNum) {
+            // the frame is reused for the next render right after this, but the
+            // readback is ordered before any later draws so that is fine
+            if (yuv) {
+                yuv->convert(vidFrame);
+                return yuv->queue(&ring, frameNum);
+            }
+            return ring.queue(vidFrame, frameNum);
+        },
+        [this](std::span<const uint8_t> data, AVFrame* out, ExportPipeline::ConvertContext& ctx) {
+            return yuv ? convertI420(data.data(), out) : convertRGBA(data.data(), out, ctx);
+        },
+        [this](AVFrame* out) {
+            return sendFrame(out);
+        }
     );
+
+    ok = pipeline->isOk();
 }
 
 void VideoRenderer::addFrame(std::shared_ptr<Frame> vidFrame) {
-    auto frameData = vidFrame->getFrameData();
-    const uint8_t* src_slices[1] = { frameData.data() };
+    if (!ok) return;
+
+    if (!pipeline->submit(vidFrame.get())) {
+        std::cerr << "Export pipeline failed at frame " << currentFrame << "\n";
+        ok = false;
+    }
+    currentFrame++;
+}
+
+bool VideoRenderer::convertRGBA(const uint8_t* data, AVFrame* out, ExportPipeline::ConvertContext& ctx) {
+    // the common 8 bit 4:2:0 layouts have simd kernels, anything else (prores' 10 bit 4:2:2) goes through swscale
+    switch (out->format) {
+        case AV_PIX_FMT_YUV420P:
+            return pixel::rgbaToI420(
+                data, 4 * width,
+                out->data[0], out->linesize[0], out->data[1], out->linesize[1], out->data[2], out->linesize[2],
+                width, height
+            );
+        case AV_PIX_FMT_NV12:
+            return pixel::rgbaToNV12(
+                data, 4 * width,
+                out->data[0], out->linesize[0], out->data[1], out->linesize[1],
+                width, height
+            );
+        default:
+            break;
+    }
+
+    // one context per worker, swscale contexts can't be shared between threads
+    if (!ctx.sws) {
+        ctx.sws = sws_getContext(
+            width, height, AV_PIX_FMT_RGBA,
+            width, height, static_cast<AVPixelFormat>(out->format),
+            SWS_BILINEAR, nullptr, nullptr, nullptr
+        );
+        if (!ctx.sws) return false;
+    }
+
+    const uint8_t* src_slices[1] = { data };
     int src_stride[1] = { 4 * width };
-    sws_scale(sws_ctx, src_slices, src_stride, 0, height, frame->data, frame->linesize);
-
-    frame->pts = av_rescale_q(currentFrame, AVRational{1, fps}, codec_ctx->time_base);
-    
-    if (avcodec_send_frame(codec_ctx, frame) == 0) {
-        AVPacket pkt;
-        av_init_packet(&pkt);
-        pkt.data = nullptr;
-        pkt.size = 0;
-        while (avcodec_receive_packet(codec_ctx, &pkt) == 0) {
-            pkt.stream_index = stream->index;
-            av_packet_rescale_ts(&pkt, codec_ctx->time_base, stream->time_base);
-            av_interleaved_write_frame(fmt_ctx, &pkt);
-            av_packet_unref(&pkt);
-        }
+    sws_scale(ctx.sws, src_slices, src_stride, 0, height, out->data, out->linesize);
+    return true;
+}
+
+bool VideoRenderer::convertI420(const uint8_t* data, AVFrame* out) {
+    // the planes come back tightly packed, the AVFrame's lines are padded
+    int chromaWidth = yuv->getChromaWidth();
+    int chromaHeight = yuv->getChromaHeight();
+    const uint8_t* u = data + static_cast<size_t>(width) * height;
+    const uint8_t* v = u + static_cast<size_t>(chromaWidth) * chromaHeight;
+
+    pixel::copyPlane(data, width, out->data[0], out->linesize[0], width, height);
+    pixel::copyPlane(u, chromaWidth, out->data[1], out->linesize[1], chromaWidth, chromaHeight);
+    pixel::copyPlane(v, chromaWidth, out->data[2], out->linesize[2], chromaWidth, chromaHeight);
+    return true;
+}
+
+bool VideoRenderer::sendFrame(AVFrame* out) {
+    out->pts = av_rescale_q(encodedFrames, AVRational{1, fps}, codec_ctx->time_base);
+    encodedFrames++;
+
+    if (avcodec_send_frame(codec_ctx, out) < 0) {
+        std::cerr << "Could not send frame " << encodedFrames - 1 << "\n";
+        return false;
     }
 
-    currentFrame++;
+    if (!writePackets(codec_ctx, stream)) {
+        std::cerr << "Could not write frame " << encodedFrames - 1 << "\n";
+        return false;
+    }
+
+    // keep the audio caught up with the video so the muxer can interleave
+    // them as it goes instead of buffering one of the streams
+    if (audio) {
+        return encodeAudioUntil(av_rescale(encodedFrames, AudioRenderer::SAMPLE_RATE, fps));
+    }
+
+    return true;
 }
 
-void VideoRenderer::addAudio(std::vector<float>& data) {
-    const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_AAC);
-    if (!codec) throw std::runtime_error("AAC encoder not found");
+bool VideoRenderer::writePackets(AVCodecContext* ctx, AVStream* st) {
+    AVPacket* pkt = av_packet_alloc();
+    int ret = 0;
+    while ((ret = avcodec_receive_packet(ctx, pkt)) == 0) {
+        pkt->stream_index = st->index;
+        av_packet_rescale_ts(pkt, ctx->time_base, st->time_base);
+        ret = av_interleaved_write_frame(fmt_ctx, pkt);
+        if (ret < 0) break;
+    }
+    av_packet_free(&pkt);
+
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+}
+
+// the mix is float, so either float layout can be copied straight in. anything
+// else (libopus without float support, say) goes through swresample
+static AVSampleFormat pickSampleFormat(const AVCodecContext* ctx, const AVCodec* codec) {
+    const AVSampleFormat* formats = nullptr;
+    int count = 0;
+    if (avcodec_get_supported_config(ctx, codec, AV_CODEC_CONFIG_SAMPLE_FORMAT, 0, (const void**)&formats, &count) < 0 || !formats) {
+        // no list means anything goes
+        return AV_SAMPLE_FMT_FLTP;
+    }
+
+    for (auto wanted : { AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_FLT }) {
+        for (int i = 0; i < count; i++) {
+            if (formats[i] == wanted) return wanted;
+        }
+    }
+    return count > 0 ? formats[0] : AV_SAMPLE_FMT_NONE;
+}
 
-    AVStream* audio_st = avformat_new_stream(fmt_ctx, codec);
-    if (!audio_st) throw std::runtime_error("Failed to create audio stream");
+bool VideoRenderer::openAudio() {
+    // aac everywhere except containers that don't take it (webm)
+    AVCodecID audioCodecId = AV_CODEC_ID_AAC;
+    if (avformat_query_codec(fmt_ctx->oformat, AV_CODEC_ID_AAC, FF_COMPLIANCE_NORMAL) == 0) {
+        audioCodecId = AV_CODEC_ID_OPUS;
+    }
 
-    AVCodecContext* enc_ctx = avcodec_alloc_context3(codec);
-    av_channel_layout_default(&enc_ctx->ch_layout, 2);
-    enc_ctx->sample_rate = 48000;
-    enc_ctx->sample_fmt  = codec->sample_fmts[0];
-    enc_ctx->bit_rate    = 128000;
-    enc_ctx->time_base   = {1, 48000};
+    const AVCodec* audioCodec = audioCodecId == AV_CODEC_ID_OPUS
+        ? avcodec_find_encoder_by_name("libopus")
+        : avcodec_find_encoder(audioCodecId);
+    if (!audioCodec) {
+        std::cerr << "Audio encoder for " << avcodec_get_name(audioCodecId) << " not found\n";
+        return false;
+    }
 
-    if (avcodec_open2(enc_ctx, codec, nullptr) < 0)
-        throw std::runtime_error("Failed to open AAC encoder");
+    audio_stream = avformat_new_stream(fmt_ctx, nullptr);
 
-    if (avcodec_parameters_from_context(audio_st->codecpar, enc_ctx) < 0)
-        throw std::runtime_error("Failed to copy encoder parameters");
+    audio_codec_ctx = avcodec_alloc_context3(audioCodec);
+    av_channel_layout_default(&audio_codec_ctx->ch_layout, AudioRenderer::CHANNELS);
+    audio_codec_ctx->sample_rate = AudioRenderer::SAMPLE_RATE;
+    audio_codec_ctx->sample_fmt = pickSampleFormat(audio_codec_ctx, audioCodec);
+    audio_codec_ctx->bit_rate = 192000;
+    audio_codec_ctx->time_base = AVRational{1, AudioRenderer::SAMPLE_RATE};
 
-    avformat_write_header(fmt_ctx, nullptr);
+    if (fmt_ctx->oformat->flags & AVFMT_GLOBALHEADER)
+        audio_codec_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
-    AVFrame* frame = av_frame_alloc();
-    if (!frame) {
-        // uh oh error!
-        return;
+    if (avcodec_open2(audio_codec_ctx, audioCodec, nullptr) < 0) {
+        std::cerr << "Could not open " << audioCodec->name << " encoder\n";
+        return false;
     }
 
-    frame->nb_samples     = enc_ctx->frame_size;
-    frame->format         = AV_SAMPLE_FMT_FLT;
-    frame->sample_rate    = 48000;
-    av_channel_layout_copy(&frame->ch_layout, &enc_ctx->ch_layout);
+    avcodec_parameters_from_context(audio_stream->codecpar, audio_codec_ctx);
+    audio_stream->time_base = audio_codec_ctx->time_base;
+
+    audioFrame = av_frame_alloc();
+    audioFrame->nb_samples = audio_codec_ctx->frame_size > 0 ? audio_codec_ctx->frame_size : 1024;
+    audioFrame->format = audio_codec_ctx->sample_fmt;
+    audioFrame->sample_rate = audio_codec_ctx->sample_rate;
+    av_channel_layout_copy(&audioFrame->ch_layout, &audio_codec_ctx->ch_layout);
+    if (av_frame_get_buffer(audioFrame, 0) < 0) {
+        std::cerr << "Could not allocate audio frame\n";
+        return false;
+    }
 
-    int ret = av_frame_get_buffer(frame, 0);
-    if (ret < 0) {
-        av_frame_free(&frame);
-        return;
+    auto format = audio_codec_ctx->sample_fmt;
+    if (format != AV_SAMPLE_FMT_FLT && format != AV_SAMPLE_FMT_FLTP) {
+        if (
+            swr_alloc_set_opts2(
+                &audioResampler,
+                &audio_codec_ctx->ch_layout, format, audio_codec_ctx->sample_rate,
+                &audio_codec_ctx->ch_layout, AV_SAMPLE_FMT_FLT, audio_codec_ctx->sample_rate,
+                0, nullptr
+            ) < 0 || swr_init(audioResampler) < 0
+        ) {
+            std::cerr << "Could not convert audio to " << av_get_sample_fmt_name(format) << " for " << audioCodec->name << "\n";
+            return false;
+        }
     }
 
-    bool planar = av_sample_fmt_is_planar((AVSampleFormat)frame->format);
-    int planes = planar ? 2 : 1;
-    int samples_per_plane = planar ? enc_ctx->frame_size : enc_ctx->frame_size * 2;
+    audioFrameSize = audioFrame->nb_samples;
+    mixBuffer.resize(audioFrameSize * AudioRenderer::CHANNELS);
+    return true;
+}
+
+bool VideoRenderer::encodeAudioUntil(int64_t targetSample) {
+    while (audioSamples < targetSample && !audio->isDone()) {
+        int count = audio->mix(mixBuffer.data(), audioFrameSize);
+        if (count <= 0) break;
+
+        if (av_frame_make_writable(audioFrame) < 0) return false;
 
-    // Copy PCM samples safely
-    for (int ch = 0; ch < planes; ch++) {
-        float* dst = reinterpret_cast<float*>(frame->data[ch]);
-        const float* src = data.data() + ch * 2 + (planar ? ch * enc_ctx->frame_size : 0);
+        // only the very last frame is allowed to be short
+        audioFrame->nb_samples = count;
 
-        if (planar) {
-            for (int i = 0; i < enc_ctx->frame_size; i++) {
-                dst[i] = data[(ch + i) * 2 + ch];
+        if (audioResampler) {
+            const uint8_t* src = reinterpret_cast<const uint8_t*>(mixBuffer.data());
+            // same rate on both sides, so nothing is buffered and every sample comes out
+            if (swr_convert(audioResampler, audioFrame->data, count, &src, count) != count) {
+                std::cerr << "Could not convert audio at sample " << audioSamples << "\n";
+                return false;
+            }
+        } else if (av_sample_fmt_is_planar(audio_codec_ctx->sample_fmt)) {
+            for (int ch = 0; ch < AudioRenderer::CHANNELS; ch++) {
+                float* dst = reinterpret_cast<float*>(audioFrame->data[ch]);
+                for (int i = 0; i < count; i++) {
+                    dst[i] = mixBuffer[i * AudioRenderer::CHANNELS + ch];
+                }
             }
         } else {
-            memcpy(dst, src, samples_per_plane * sizeof(float));
+            memcpy(audioFrame->data[0], mixBuffer.data(), count * AudioRenderer::CHANNELS * sizeof(float));
         }
-    }
 
-    // Now send frame to encoder
-    ret = avcodec_send_frame(enc_ctx, frame);
-    av_frame_free(&frame);
+        audioFrame->pts = audioSamples;
+        audioSamples += count;
+
+        if (avcodec_send_frame(audio_codec_ctx, audioFrame) < 0 || !writePackets(audio_codec_ctx, audio_stream)) {
+            std::cerr << "Could not encode audio at sample " << audioSamples << "\n";
+            return false;
+        }
+    }
 
-    av_write_trailer(fmt_ctx);
-    avcodec_free_context(&enc_ctx);
+    return true;
 }
 
-void VideoRenderer::finish() {
-    avcodec_send_frame(codec_ctx, nullptr);  // flush signal
+bool VideoRenderer::finish() {
+    if (pipeline) {
+        if (!pipeline->finish()) ok = false;
+        stats = pipeline->getStats();
+        pipeline.reset();
+    }
+    yuv.reset();
 
-    AVPacket pkt;
-    av_init_packet(&pkt);
-    pkt.data = nullptr;
-    pkt.size = 0;
+    if (ok) {
+        avcodec_send_frame(codec_ctx, nullptr);  // flush signal
+        if (!writePackets(codec_ctx, stream)) ok = false;
 
-    while (avcodec_receive_packet(codec_ctx, &pkt) == 0) {
-        av_packet_rescale_ts(&pkt, codec_ctx->time_base, stream->time_base);
-        pkt.stream_index = stream->index;
-        av_interleaved_write_frame(fmt_ctx, &pkt);
-        av_packet_unref(&pkt);
-    }
+        if (audio) {
+            // whatever audio runs past the last frame, then flush that too
+            if (!encodeAudioUntil(audio->getLength())) ok = false;
+            avcodec_send_frame(audio_codec_ctx, nullptr);
+            if (!writePackets(audio_codec_ctx, audio_stream)) ok = false;
+        }
 
-    av_write_trailer(fmt_ctx);
+        if (av_write_trailer(fmt_ctx) < 0) {
+            std::cerr << "Error writing trailer\n";
+            ok = false;
+        }
+    }
 
-    if (!(fmt_ctx->oformat->flags & AVFMT_NOFILE)) {
+    if (fmt_ctx && fmt_ctx->pb && !(fmt_ctx->oformat->flags & AVFMT_NOFILE)) {
         avio_close(fmt_ctx->pb);
     }
 
     avcodec_free_context(&codec_ctx);
-    av_frame_free(&frame);
-    sws_freeContext(sws_ctx);
+    avcodec_free_context(&audio_codec_ctx);
+    av_frame_free(&audioFrame);
+    swr_free(&audioResampler);
     avformat_free_context(fmt_ctx);
+    fmt_ctx = nullptr;
+
+    return ok;
 }
@@ -0,0 +1,116 @@
+#include <renderer/yuv.hpp>
+#include <renderer/readback.hpp>
+#include <frame.hpp>
+
+#include <shaders/shader.hpp>
+#include <shaders/yuv.hpp>
+
+#include <fmt/base.h>
+
+YUVConverter::YUVConverter(int width, int height): width(width), height(height) {
+    // odd sizes round the chroma planes up, same as libavutil does
+    chromaWidth = (width + 1) / 2;
+    chromaHeight = (height + 1) / 2;
+
+    yTexture = createPlane(width, height);
+    uTexture = createPlane(chromaWidth, chromaHeight);
+    vTexture = createPlane(chromaWidth, chromaHeight);
+
+    glGenFramebuffers(1, &yFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, yFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, yTexture, 0);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    glGenFramebuffers(1, &uvFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, uvFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, uTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, vTexture, 0);
+    GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+    complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete) {
+        fmt::println("YUV framebuffers are incomplete, falling back to CPU conversion");
+        return;
+    }
+
+    yProgram = &shader::getProgram(yuvVertex, yuvFragmentY);
+    uvProgram = &shader::getProgram(yuvVertex, yuvFragmentUV);
+
+    // core profile won't draw without a VAO bound, even with no attributes
+    glGenVertexArrays(1, &VAO);
+
+    ok = true;
+}
+
+YUVConverter::~YUVConverter() {
+    glDeleteFramebuffers(1, &yFbo);
+    glDeleteFramebuffers(1, &uvFbo);
+
+    GLuint textures[3] = { yTexture, uTexture, vTexture };
+    glDeleteTextures(3, textures);
+
+    if (VAO) glDeleteVertexArrays(1, &VAO);
+}
+
+GLuint YUVConverter::createPlane(int w, int h) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+size_t YUVConverter::getBufferSize() const {
+    return static_cast<size_t>(width) * height + static_cast<size_t>(chromaWidth) * chromaHeight * 2;
+}
+
+void YUVConverter::convert(Frame* frame) {
+    if (!ok) return;
+    frame->flush();
+
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_BLEND);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, frame->textureID);
+    glBindVertexArray(VAO);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, yFbo);
+    glViewport(0, 0, width, height);
+    yProgram->use();
+    glUniform1i(yProgram->uniform("source"), 0);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, uvFbo);
+    glViewport(0, 0, chromaWidth, chromaHeight);
+    uvProgram->use();
+    glUniform1i(uvProgram->uniform("source"), 0);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (blend) glEnable(GL_BLEND);
+}
+
+bool YUVConverter::queue(ReadbackRing* ring, int frameNum) {
+    if (!ok || !ring->begin(frameNum)) return false;
+
+    size_t ySize = static_cast<size_t>(width) * height;
+    size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+
+    ring->read(yFbo, width, height, GL_RED, 0);
+    ring->read(uvFbo, chromaWidth, chromaHeight, GL_RED, ySize, GL_COLOR_ATTACHMENT0);
+    ring->read(uvFbo, chromaWidth, chromaHeight, GL_RED, ySize + chromaSize, GL_COLOR_ATTACHMENT1);
+    ring->end();
+    return true;
+}
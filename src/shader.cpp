@@ -1,6 +1,10 @@
 #include <shaders/shader.hpp>
 #include <fmt/base.h>
 
+#include <map>
+#include <memory>
+#include <utility>
+
 namespace shader {
     GLuint compileShader(GLenum type, const char* source) {
         GLuint shader = glCreateShader(type);
@@ -16,7 +20,6 @@ namespace shader {
         }
 
         return shader;
-        return 0;
     }
 
     GLuint createProgram(const char* vertex, const char* fragment) {
@@ -30,14 +33,41 @@ namespace shader {
         glLinkProgram(program);
 
         int success = 0;
-        glGetProgramiv(program, GL_COMPILE_STATUS, &success);
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
         if (!success) {
             char infoLog[512];
             glGetProgramInfoLog(program, 512, nullptr, infoLog);
             fmt::println("no program link! ({})", infoLog);
         }
 
+        // the program keeps what it needs
+        glDetachShader(program, vertexShader);
+        glDetachShader(program, fragmentShader);
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
         return program;
-        return 0;
+    }
+
+    GLint Program::uniform(std::string_view name) {
+        if (auto it = uniforms.find(name); it != uniforms.end()) {
+            return it->second;
+        }
+
+        std::string key(name);
+        GLint location = glGetUniformLocation(id, key.c_str());
+        uniforms.emplace(std::move(key), location);
+        return location;
+    }
+
+    Program& getProgram(const char* vertex, const char* fragment) {
+        // only ever touched from the GL thread
+        static std::map<std::pair<const char*, const char*>, std::unique_ptr<Program>> programs;
+
+        auto& program = programs[{ vertex, fragment }];
+        if (!program) {
+            program = std::make_unique<Program>(createProgram(vertex, fragment));
+        }
+        return *program;
     }
 }
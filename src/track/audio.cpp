@@ -126,8 +126,7 @@ void AudioClip::setVolume(float volume) {
 void AudioTrack::processTime() {
     auto& state = State::get();
     auto currentFrame = state.currentFrame;
-    for (auto _clip : clips) {
-        auto clip = _clip.second;
+    for (auto& clip : clips) {
         if (currentFrame >= clip->startFrame && currentFrame < clip->startFrame + clip->duration && state.isPlaying) {
             float seconds = state.video->timeForFrame(currentFrame - clip->startFrame);
             // the threshold is how far off the playback audio can be before we re-align it
@@ -163,16 +162,13 @@ void AudioTrack::processTime() {
 void AudioTrack::onPlay() {
     auto& state = State::get();
     // filters clips that should be playing now
-    for (auto _clip : clips) {
-        auto clip = _clip.second;
-        if (state.currentFrame >= clip->startFrame && state.currentFrame <= clip->startFrame + clip->duration) {
-            clip->seekToSec(state.video->timeForFrame(state.currentFrame - clip->startFrame));
-        }
-    }
+    index.forEachAt(state.currentFrame, [&](const std::shared_ptr<AudioClip>& clip) {
+        clip->seekToSec(state.video->timeForFrame(state.currentFrame - clip->startFrame));
+    });
 }
 
 void AudioTrack::onStop() {
-    for (auto clip : clips) {
-        clip.second->stop();
+    for (auto& clip : clips) {
+        clip->stop();
     }
 }
@@ -1,28 +1,160 @@
 #include <track/video.hpp>
 
 #include <utils.hpp>
+#include <renderer/pool.hpp>
 
-void VideoTrack::render(Frame* frame, int targetFrame) {
-    for (auto _clip : clips) {
-        auto clip = _clip.second;
-        if (targetFrame >= clip->startFrame && targetFrame <= clip->startFrame + clip->duration) {
-            // process keyframes
-            for (auto [id, property] : clip->m_properties) {
+#include <algorithm>
+
+// grows a cache's view to a multiple of VIEW_STEP pixels (kept inside the frame), so
+// clips of about the same size share pooled frames and small edits don't reallocate
+static PixelRect roundView(PixelRect view, int fullWidth, int fullHeight) {
+    constexpr int VIEW_STEP = 64;
+
+    auto grow = [&](int& start, int& size, int full) {
+        size = std::min((size + VIEW_STEP - 1) / VIEW_STEP * VIEW_STEP, full);
+        start = std::clamp(start, 0, full - size);
+    };
+    grow(view.x, view.width, fullWidth);
+    grow(view.y, view.height, fullHeight);
+    return view;
+}
+
+std::vector<VideoTrack::ActiveClip> VideoTrack::prepare(int targetFrame, size_t& hash) {
+    std::vector<ActiveClip> active;
+    std::vector<std::shared_ptr<Clip>> onScreen;
+
+    index.forEachAt(targetFrame, [&](const std::shared_ptr<Clip>& clip) {
+        // a time invariant clip evaluates to the same thing on every frame, so its properties
+        // are only processed and hashed again once one of their keyframes was edited
+        bool invariant = clip->isTimeInvariant();
+        uint64_t version = invariant ? clip->getKeyframeVersions() : UINT64_MAX;
+
+        size_t clipHash;
+        if (invariant && clip->evaluatedVersion == version) {
+            clipHash = clip->evaluatedHash;
+        } else {
+            for (auto& [id, property] : clip->m_properties) {
                 property->processKeyframe(targetFrame);
             }
 
-            int relativeFrame = targetFrame - clip->startFrame;
-            clip->opacity = 1;
-            if (relativeFrame < clip->fadeInFrame) {
-                clip->opacity = utils::interpolate(relativeFrame * 1.f / clip->fadeInFrame, 0, 1);
+            clipHash = utils::hashValue(clip->uID);
+            for (auto& [id, property] : clip->m_properties) {
+                property->hashData(clipHash);
             }
 
-            int fadeOutStart = clip->duration - clip->fadeOutFrame;
-            if (relativeFrame >= fadeOutStart) {
-                clip->opacity = utils::interpolate((relativeFrame - fadeOutStart) * 1.f / clip->fadeOutFrame, 1, 0);
+            clip->evaluatedVersion = version;
+            clip->evaluatedHash = clipHash;
+        }
+        clip->hashContent(clipHash);
+
+        int relativeFrame = targetFrame - clip->startFrame;
+        clip->opacity = 1;
+        if (relativeFrame < clip->fadeInFrame) {
+            clip->opacity = utils::interpolate(relativeFrame * 1.f / clip->fadeInFrame, 0, 1);
+        }
+
+        int fadeOutStart = clip->duration - clip->fadeOutFrame;
+        if (relativeFrame >= fadeOutStart) {
+            clip->opacity = utils::interpolate((relativeFrame - fadeOutStart) * 1.f / clip->fadeOutFrame, 1, 0);
+        }
+
+        utils::hashCombine(hash, clipHash);
+        utils::hashCombine(hash, utils::hashValue(clip->opacity));
+
+        active.push_back({ clip, clipHash, invariant });
+        onScreen.push_back(clip);
+    });
+
+    // only kept around while the clip is on screen
+    for (auto& clip : lastActive) {
+        if (std::find(onScreen.begin(), onScreen.end(), clip) == onScreen.end()) {
+            clip->releaseStaticCache();
+            clip->onInactive();
+        }
+    }
+    lastActive = std::move(onScreen);
+
+    return active;
+}
+
+void VideoTrack::drawClip(const ActiveClip& active, Frame* target) {
+    auto& clip = active.clip;
+    if (!active.invariant) {
+        clip->releaseStaticCache();
+        clip->render(target);
+        return;
+    }
+
+    auto& cache = clip->staticCache;
+    bool stale = clip->staticHash != active.hash;
+    if (cache) {
+        stale |= cache->width != target->width || cache->height != target->height || cache->scale != target->scale;
+    } else {
+        stale |= !clip->staticEmpty;
+    }
+
+    if (stale) {
+        // drawn opaque, the fade is applied when blitting
+        float opacity = clip->opacity;
+        clip->opacity = 1.f;
+
+        // a dry run first, so the cache only has to cover what the clip draws
+        target->beginMeasure();
+        clip->render(target);
+        auto bounds = target->endMeasure();
+
+        clip->staticEmpty = !bounds;
+        if (bounds) {
+            auto view = roundView(*bounds, target->getFullTextureWidth(), target->getFullTextureHeight());
+            bool fits = cache && cache->width == target->width && cache->height == target->height && cache->scale == target->scale
+                && cache->textureWidth == view.width && cache->textureHeight == view.height;
+            if (fits) {
+                cache->viewX = view.x;
+                cache->viewY = view.y;
+            } else {
+                cache = FramePool::get().acquire(target->width, target->height, target->scale, view);
             }
 
-            clip->render(frame);
+            cache->clearFrame({ 0, 0, 0, 0 });
+            clip->render(cache.get());
+            cache->flush();
+        } else {
+            cache = nullptr;
         }
+
+        clip->opacity = opacity;
+        clip->staticHash = active.hash;
+    }
+
+    if (cache) target->drawLayer(cache.get(), clip->opacity);
+}
+
+void VideoTrack::render(Frame* frame, int targetFrame) {
+    size_t hash = 0;
+    for (auto& active : prepare(targetFrame, hash)) {
+        drawClip(active, frame);
+    }
+}
+
+Frame* VideoTrack::renderLayer(int targetFrame, Frame* target) {
+    size_t hash = 0;
+    auto active = prepare(targetFrame, hash);
+    if (active.empty()) return nullptr;
+
+    if (!layer || layer->width != target->width || layer->height != target->height || layer->scale != target->scale) {
+        layer = FramePool::get().acquire(target->width, target->height, target->scale);
+        layerValid = false;
     }
+
+    if (layerValid && hash == layerHash) return layer.get();
+
+    layer->clearFrame({ 0, 0, 0, 0 });
+    for (auto& clip : active) {
+        drawClip(clip, layer.get());
+    }
+    layer->flush();
+
+    layerHash = hash;
+    layerValid = true;
+    return layer.get();
 }
@@ -8,6 +8,7 @@
 #include <fmt/color.h>
 
 #include <state.hpp>
+#include <renderer/pool.hpp>
 #include <widgets.hpp>
 
 #include <imgui_impl_opengl3.h>
@@ -98,16 +99,32 @@ void Application::draw() {
     }
 
     auto resolution = state.video->getResolution();
+
+    // no point compositing more pixels than the player has room to show
+    float previewScale = previewScaler.getScale(state.previewQuality, displayScale, state.isPlaying);
+    if (frame->width != resolution.x || frame->height != resolution.y || frame->scale != previewScale) {
+        frame = FramePool::get().acquire(resolution.x, resolution.y, previewScale);
+        state.lastRenderedFrame = -1;
+    }
+
     if (state.lastRenderedFrame != state.currentFrame) {
+        auto renderStart = steady_clock::now();
+
         frame->clearFrame();
         state.video->renderIntoFrame(state.currentFrame, frame);
         state.lastRenderedFrame = state.currentFrame;
+
+        if (state.isPlaying) {
+            double renderMs = duration<double, std::milli>(steady_clock::now() - renderStart).count();
+            previewScaler.addSample(renderMs, 1000.0 / state.video->getFPS());
+        }
     }
 
     ImGui::SetNextWindowClass(&bareWindowClass);
     ImGui::Begin("Player");
     ImVec2 avail = ImGui::GetContentRegionAvail();
     auto scale = ImMin(avail.x / resolution.x, (avail.y - 75) / resolution.y);
+    displayScale = scale;
     ImVec2 imageSize = ImVec2(resolution.x * scale, resolution.y * scale);
     ImVec2 imagePos = ImVec2((ImGui::GetWindowSize().x - imageSize.x) * 0.5f , ImGui::GetCursorPosY());
 
@@ -186,7 +203,7 @@ void Application::run() {
 
     auto& state = State::get();
     auto resolution = state.video->getResolution();
-    frame = std::make_shared<Frame>(resolution.x, resolution.y);
+    frame = FramePool::get().acquire(resolution.x, resolution.y);
 
     while (running) {
         SDL_Event event;
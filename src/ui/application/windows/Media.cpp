@@ -4,6 +4,7 @@
 #include <action/actions/CreateClip.hpp>
 #include <action/actions/CreateVideoClip.hpp>
 #include <clips/properties/number.hpp>
+#include <proxy/writer.hpp>
 
 void Application::drawMediaWindow() {
     auto& state = State::get();
@@ -56,6 +57,11 @@ void Application::drawMediaWindow() {
                         //     .filePath = fmt::format("{}.mp3", outFile),
                         //     .frameCount = frameCount
                         // });
+
+                        // clips pick the proxy up on their own once it's in place
+                        if (!vpf::hasProxy(outFile)) {
+                            ProxyWriter(outFile).write();
+                        }
                     });
                     convertThread.detach();
                 }
@@ -1,7 +1,9 @@
 #include <Application.hpp>
 #include <state.hpp>
 #include <filesystem>
-#include <renderer/audio.hpp>
+#include <renderer/export.hpp>
+#include <cache/frame.hpp>
+#include <renderer/pool.hpp>
 
 #include <fstream>
 #include <nfd.h>
@@ -55,14 +57,10 @@ void Application::drawMenuBar() {
                 );
 
                 if (result == NFD_OKAY) {
-                    std::ifstream file(outPath, std::ios::binary);
-                    std::vector<unsigned char> fileBuffer(std::istreambuf_iterator<char>(file), {});
-                    qn::ByteReader reader(fileBuffer);
-                    std::shared_ptr<Video> video = std::make_shared<Video>();
-                    video->read(reader);
-                    fmt::println("{}", video->getTracks().size());
-
-                    state.video = video;
+                    if (auto video = Video::fromFile(ensureCStr(outPath))) {
+                        fmt::println("{}", video->getTracks().size());
+                        state.video = video;
+                    }
                 }
                 else if (result == NFD_CANCEL) {}
 
@@ -89,6 +87,57 @@ void Application::drawMenuBar() {
                 ImGui::OpenPopup(exportId);
             }
 
+            if (ImGui::BeginMenu("Preview Quality")) {
+                for (size_t i = 0; i < PREVIEW_QUALITY_NAMES.size(); i++) {
+                    bool selected = state.previewQuality == (PreviewQuality)i;
+                    if (ImGui::MenuItem(PREVIEW_QUALITY_NAMES[i], nullptr, selected)) {
+                        state.previewQuality = (PreviewQuality)i;
+                    }
+                }
+
+                ImGui::EndMenu();
+            }
+
+            if (ImGui::BeginMenu("Frame Pool")) {
+                auto& pool = FramePool::get();
+                constexpr size_t MB = 1024 * 1024;
+
+                int budget = pool.getBudget() / MB;
+                if (ImGui::SliderInt("Budget (MB)", &budget, 128, 8192)) {
+                    pool.setBudget((size_t)budget * MB);
+                }
+
+                ImGui::Text("%d leased, %d idle, %zu MB", pool.getLeased(), pool.getIdle(), pool.getUsage() / MB);
+                ImGui::Text("%d allocated in total", pool.getCreated());
+
+                if (ImGui::MenuItem("Release Idle")) {
+                    pool.clear();
+                }
+
+                ImGui::EndMenu();
+            }
+
+            if (ImGui::BeginMenu("Frame Cache")) {
+                auto& cache = FrameCache::get();
+                constexpr size_t MB = 1024 * 1024;
+
+                int budget = cache.getBudget() / MB;
+                if (ImGui::SliderInt("Budget (MB)", &budget, 64, 8192)) {
+                    cache.setBudget((size_t)budget * MB);
+                }
+
+                size_t hits = cache.getHits();
+                size_t lookups = hits + cache.getMisses();
+                ImGui::Text("%zu frames, %zu MB", cache.getCount(), cache.getUsage() / MB);
+                ImGui::Text("%zu / %zu hits (%.0f%%)", hits, lookups, lookups > 0 ? 100.0 * hits / lookups : 0.0);
+
+                if (ImGui::MenuItem("Clear")) {
+                    cache.clear();
+                }
+
+                ImGui::EndMenu();
+            }
+
             ImGui::EndMenu();
         }
 
@@ -122,39 +171,100 @@ void Application::drawMenuBar() {
             else if (result == NFD_CANCEL) {}
         }
 
-        ImGui::Separator();
+        auto& settings = state.exportSettings;
 
-        if (ImGui::Button("Export")) {
-            // .mp4
-            auto exportPath = std::filesystem::path(state.exportPath);
-            auto videoFilename = std::filesystem::path(exportPath)
-                .replace_extension(
-                    fmt::format(".na.{}", exportPath.extension().string())
-                ).string();
-
-            auto audioFilename = fmt::format("{}.wav", state.exportPath);
-            VideoRenderer renderer(videoFilename, state.video->getResolution().x, state.video->getResolution().y, state.video->getFPS());
-            state.video->render(&renderer);
-
-            AudioRenderer audio(audioFilename, state.video->timeForFrame(state.video->frameCount));
-            for (auto track : state.video->audioTracks) {
-                for (auto _clip : track->getClips()) {
-                    auto clip = _clip.second;
-                    audio.addClip(
-                        clip->getPath(),
-                        state.video->timeForFrame(clip->startFrame),
-                        state.video->timeForFrame(clip->startFrame + clip->duration),
-                        clip->getProperty<NumberProperty>("volume").unwrap()
-                    );
+        ImGui::SeparatorText("Encoding");
+
+        auto currentCodec = EXPORT_CODEC_NAMES[(int)settings.codec];
+        if (ImGui::BeginCombo("Codec", currentCodec)) {
+            for (int i = 0; i < EXPORT_CODEC_NAMES.size(); i++) {
+                bool selected = i == (int)settings.codec;
+                if (ImGui::Selectable(EXPORT_CODEC_NAMES[i], selected)) {
+                    settings.codec = (ExportCodec)i;
+                    settings.crf = std::min(settings.crf, settings.maxCRF());
+                }
+
+                if (selected) {
+                    ImGui::SetItemDefaultFocus();
                 }
             }
-            audio.render(state.video->getFPS());
 
-            // renderer.addAudio(pcmData);
+            ImGui::EndCombo();
+        }
 
-            renderer.finish();
+        if (settings.codec == ExportCodec::ProRes) {
+            ImGui::TextDisabled("ProRes should be exported to a .mov file");
+        } else {
+            auto currentPreset = EXPORT_PRESET_NAMES[(int)settings.preset];
+            if (ImGui::BeginCombo("Preset", currentPreset)) {
+                for (int i = 0; i < EXPORT_PRESET_NAMES.size(); i++) {
+                    bool selected = i == (int)settings.preset;
+                    if (ImGui::Selectable(EXPORT_PRESET_NAMES[i], selected)) {
+                        settings.preset = (ExportPreset)i;
+                    }
 
-            utils::video::combineAV(audioFilename, videoFilename, state.exportPath);
+                    if (selected) {
+                        ImGui::SetItemDefaultFocus();
+                    }
+                }
+
+                ImGui::EndCombo();
+            }
+
+            auto currentRateControl = RATE_CONTROL_NAMES[(int)settings.rateControl];
+            if (ImGui::BeginCombo("Rate Control", currentRateControl)) {
+                for (int i = 0; i < RATE_CONTROL_NAMES.size(); i++) {
+                    bool selected = i == (int)settings.rateControl;
+                    if (ImGui::Selectable(RATE_CONTROL_NAMES[i], selected)) {
+                        settings.rateControl = (RateControl)i;
+                    }
+
+                    if (selected) {
+                        ImGui::SetItemDefaultFocus();
+                    }
+                }
+
+                ImGui::EndCombo();
+            }
+
+            if (settings.rateControl == RateControl::CRF) {
+                ImGui::SliderInt("CRF", &settings.crf, 0, settings.maxCRF());
+            } else {
+                ImGui::InputInt("Bitrate (kbps)", &settings.bitrate, 500, 5000);
+                settings.bitrate = std::max(settings.bitrate, 100);
+            }
+
+            ImGui::InputInt("Keyframe Interval", &settings.keyframeInterval);
+            settings.keyframeInterval = std::max(settings.keyframeInterval, 1);
+        }
+
+        ImGui::InputInt("Threads (0 = auto)", &settings.threads);
+        settings.threads = std::max(settings.threads, 0);
+
+        auto currentThreading = ENCODER_THREADING_NAMES[(int)settings.threading];
+        if (ImGui::BeginCombo("Threading", currentThreading)) {
+            for (int i = 0; i < ENCODER_THREADING_NAMES.size(); i++) {
+                bool selected = i == (int)settings.threading;
+                if (ImGui::Selectable(ENCODER_THREADING_NAMES[i], selected)) {
+                    settings.threading = (EncoderThreading)i;
+                }
+
+                if (selected) {
+                    ImGui::SetItemDefaultFocus();
+                }
+            }
+
+            ImGui::EndCombo();
+        }
+
+        ImGui::Separator();
+
+        if (ImGui::Button("Export")) {
+            Exporter exporter(state.video, state.exportPath, settings);
+            if (exporter.run()) {
+                auto& stats = exporter.getStats();
+                fmt::println("exported {} frames in {:.2f}s ({:.1f} fps)", stats.frames, stats.totalSeconds, stats.fps());
+            }
 
             // ImGui::InsertNotification({
             //     ImGuiToastType::Success,
@@ -5,7 +5,7 @@ void Application::drawPlayerWindow(ImVec2 imageSize, ImVec2 imagePos, float scal
     auto& state = State::get();
 
     ImGui::SetCursorPos(imagePos);
-    ImGui::Image((ImTextureID)(uintptr_t)frame->textureID, imageSize);
+    ImGui::Image((ImTextureID)(uintptr_t)frame->getTexture(), imageSize);
 
     ImGuiIO& io = ImGui::GetIO();
 
@@ -23,7 +23,7 @@ void Application::drawPlayerWindow(ImVec2 imageSize, ImVec2 imagePos, float scal
     }
 
     ImDrawList* drawList = ImGui::GetWindowDrawList();
-    for (auto [clipID, selectedClip] : state.getSelectedClips()) {
+    for (auto selectedClip : state.getSelectedClips()) {
         if (ImGui::IsItemHovered() && ImGui::IsMouseDown(0)) {
             // mouse position in the canvas
             // in terms of the video resolution
@@ -85,8 +85,7 @@ void Application::drawPlayerWindow(ImVec2 imageSize, ImVec2 imagePos, float scal
                     // and initialPos
 
                     for (auto track : state.video->videoTracks) {
-                        for (auto _clip : track->getClips()) {
-                            auto clip = _clip.second;
+                        for (auto& clip : track->getClips()) {
                             Vector2D position = clip->getPos();
                             Vector2D size = clip->getSize();
                             // fmt::println("-------------------------");
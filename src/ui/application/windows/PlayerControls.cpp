@@ -155,11 +155,16 @@ void Application::drawPlayerControls(ImVec2 imageSize) {
 
     bool areClipsLinked = state.areClipsLinked();
     if (playbackBtn(areClipsLinked ? ICON_FA_LINK_SLASH : ICON_FA_LINK, state.selectedClips.size() <= 1, areClipsLinked)) {
-        for (auto selectedClip : state.getSelectedClips()) {
+        auto selectedClips = state.getSelectedClips();
+        std::vector<std::string> linkedIDs;
+        for (auto& selectedClip : selectedClips) {
+            linkedIDs.push_back(selectedClip->uID);
+        }
+        for (auto& selectedClip : selectedClips) {
             if (areClipsLinked) {
-                selectedClip.second->linkedClips = {};
+                selectedClip->linkedClips = {};
             } else {
-                selectedClip.second->linkedClips = state.selectedClips;
+                selectedClip->linkedClips = linkedIDs;
             }
         }
     }
@@ -19,7 +19,7 @@ void Application::drawPropertiesWindow() {
             ImGui::EndPopup();
         }
         ImGui::Separator();
-        for (auto [clipID, selectedClip] : state.getSelectedClips()) {
+        for (auto selectedClip : state.getSelectedClips()) {
             ImGui::SeparatorText(selectedClip->m_metadata.name.c_str());
 
             ImGui::SeparatorText("Properties");
@@ -36,7 +36,7 @@ void Application::drawPropertiesWindow() {
                 ImGui::Text("Are you sure you want to delete this clip?");
                 ImGui::Separator();
                 if (ImGui::Button("Yes")) {
-                    int trackIdx = state.video->getClipMap()[selectedClip->uID];
+                    int trackIdx = state.video->getClipTrack(selectedClip->handle);
                     if (timeline.selectedTrackType == TrackType::Audio) {
                         state.video->removeAudioClip(trackIdx, std::static_pointer_cast<AudioClip>(selectedClip));
                     } else {
@@ -207,16 +207,14 @@ void Timeline::drawTrack(ImDrawList* drawList, const ImVec2& canvasPos, const Im
 
     switch (type) {
         case TrackType::Audio:
-            for (const auto& _clip : state.video->audioTracks[trackIndex]->getClips()) {
-                auto clip = _clip.second;
+            for (auto& clip : state.video->audioTracks[trackIndex]->getClips()) {
                 TimelineClip timelineClip(0, "Clip", (float)clip->startFrame / state.video->getFPS(), (float)clip->duration / state.video->getFPS(), clip, IM_COL32(100, 150, 200, 255));
                 timelineClip.selected = state.isClipSelected(clip);
                 drawClip(drawList, timelineClip, content_pos, content_size, type);
             }
             break;
         case TrackType::Video:
-            for (const auto& _clip : state.video->getTracks()[trackIndex]->getClips()) {
-                auto clip = _clip.second;
+            for (auto& clip : state.video->getTracks()[trackIndex]->getClips()) {
                 TimelineClip timelineClip(0, "Clip", (float)clip->startFrame / state.video->getFPS(), (float)clip->duration / state.video->getFPS(), clip, IM_COL32(100, 150, 200, 255));
                 timelineClip.selected = state.isClipSelected(clip);
                 drawClip(drawList, timelineClip, content_pos, content_size, type);
@@ -378,11 +376,10 @@ void Timeline::drawClip(ImDrawList* drawList, const TimelineClip& clip, const Im
     if (resizeMode == RESIZE_NONE) {
         if (ImGui::IsMouseClicked(0) && clipHovered && !isPlacingClip) {
             auto& state = State::get();
-            auto id = clip.clip->uID;
             if (!io.KeyShift && !state.isClipSelected(clip.clip)) {
                 state.deselect();
             }
-            state.selectClip(id);
+            state.selectClip(clip.clip);
             originalTrackId = selectedTrackIdx;
             isDragging = true;
             isMovingBetweenTracks = false;
@@ -446,7 +443,7 @@ void Timeline::drawClip(ImDrawList* drawList, const TimelineClip& clip, const Im
             mousePos.y >= fadeInPos.y && mousePos.y <= fadeInPos.y + fadeInSize.y
         ) {
             isAdjustingFade = true;
-            fadeAdjustID = clip.clip->uID;
+            fadeAdjustClip = clip.clip->handle;
             fadeDragMode = FadeDragMode::In;
         }
     }
@@ -485,7 +482,7 @@ void Timeline::drawClip(ImDrawList* drawList, const TimelineClip& clip, const Im
             mousePos.y >= fadeOutPos.y && mousePos.y <= fadeOutPos.y + fadeOutSize.y
         ) {
             isAdjustingFade = true;
-            fadeAdjustID = clip.clip->uID;
+            fadeAdjustClip = clip.clip->handle;
             fadeDragMode = FadeDragMode::Out;
         }
     }
@@ -499,7 +496,7 @@ void Timeline::drawClip(ImDrawList* drawList, const TimelineClip& clip, const Im
         );
     }
 
-    if (isAdjustingFade && clip.clip->uID == fadeAdjustID && ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+    if (isAdjustingFade && clip.clip->handle == fadeAdjustClip && ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
         switch (fadeDragMode) {
             case FadeDragMode::In:
                 clip.clip->fadeInFrame += state.video->frameForTime(io.MouseDelta.x / pixelsPerSecond);
@@ -533,7 +530,7 @@ void Timeline::drawClip(ImDrawList* drawList, const TimelineClip& clip, const Im
 }
 
 Timeline::ResizeMode Timeline::GetResizeMode(const ImVec2& mouse_pos, std::shared_ptr<Clip> clip, const ImVec2& track_pos, const ImVec2& track_size, float clickTime) {
-    auto state = State::get();
+    auto& state = State::get();
     float clip_x = track_pos.x + ((float)clip->startFrame / state.video->getFPS() * pixelsPerSecond - scrollX);
     float clip_width = (float)clip->duration / state.video->getFPS() * pixelsPerSecond;
 
@@ -583,12 +580,12 @@ void Timeline::drawPlayhead(ImDrawList* drawList, const ImVec2& canvasPos, const
     }
 }
 
-bool Timeline::willClipCollide(int frame, int duration, int trackIdx, TrackType type, std::vector<std::string> exclusionList) {
-    auto state = State::get();
+bool Timeline::willClipCollide(int frame, int duration, int trackIdx, TrackType type, std::vector<ClipHandle> exclusionList) {
+    auto& state = State::get();
     bool collision = false;
     int endFrame = frame + duration;
     auto doTheThing = [&](std::shared_ptr<Clip> clip) {
-        if (utils::vectorContains(exclusionList, clip->uID)) return;
+        if (utils::vectorContains(exclusionList, clip->handle)) return;
 
         int clipStart = clip->startFrame;
         int clipEnd = clip->startFrame + clip->duration;
@@ -603,20 +600,20 @@ bool Timeline::willClipCollide(int frame, int duration, int trackIdx, TrackType
     };
 
     if (type == TrackType::Video) {
-        for (auto _clip : state.video->getTracks()[trackIdx]->getClips()) {
-            doTheThing(_clip.second);
+        for (auto& _clip : state.video->getTracks()[trackIdx]->getClips()) {
+            doTheThing(_clip);
             if (collision) break;
         }
     } else if (type == TrackType::Audio) {
-        for (auto _clip : state.video->audioTracks[trackIdx]->getClips()) {
-            doTheThing(_clip.second);
+        for (auto& _clip : state.video->audioTracks[trackIdx]->getClips()) {
+            doTheThing(_clip);
             if (collision) break;
         }
     }
     return collision;
 }
 
-bool Timeline::willClipCollide(float seconds, float duration, int trackIdx, TrackType type, std::vector<std::string> exclusionList) {
+bool Timeline::willClipCollide(float seconds, float duration, int trackIdx, TrackType type, std::vector<ClipHandle> exclusionList) {
     auto& state = State::get();
     return willClipCollide(state.video->frameForTime(seconds), state.video->frameForTime(duration), trackIdx, type, exclusionList);
 }
@@ -694,8 +691,7 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
 
             int newStartFrame = state.video->frameForTime(newStart);
             if (selectedTrackType == TrackType::Video) {
-                for (auto _clip : state.video->getTracks()[resizingTrackIdx]->getClips()) {
-                    auto clip = _clip.second;
+                for (auto& clip : state.video->getTracks()[resizingTrackIdx]->getClips()) {
                     if (clip == resizingClip) continue;
                     int clipEnd = clip->startFrame + clip->duration; // exclusive
 
@@ -705,8 +701,7 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
                     }
                 }
             } else {
-                for (auto _clip : state.video->audioTracks[resizingTrackIdx]->getClips()) {
-                    auto clip = _clip.second;
+                for (auto& clip : state.video->audioTracks[resizingTrackIdx]->getClips()) {
                     if (clip == resizingClip) continue;
                     int clipEnd = clip->startFrame + clip->duration; // exclusive
 
@@ -723,8 +718,7 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
             float newEndTime = std::max(minEndTime, mouse_time);
             int newEndFrame = state.video->frameForTime(newEndTime);
             if (selectedTrackType == TrackType::Video) {
-                for (auto _clip : state.video->getTracks()[resizingTrackIdx]->getClips()) {
-                    auto clip = _clip.second;
+                for (auto& clip : state.video->getTracks()[resizingTrackIdx]->getClips()) {
                     if (clip == resizingClip || clip->startFrame + clip->duration <= resizingClip->startFrame) continue;
                     int clipStart = clip->startFrame;
 
@@ -734,8 +728,7 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
                     }
                 }
             } else {
-                for (auto _clip : state.video->audioTracks[resizingTrackIdx]->getClips()) {
-                    auto clip = _clip.second;
+                for (auto& clip : state.video->audioTracks[resizingTrackIdx]->getClips()) {
                     if (clip == resizingClip || clip->startFrame + clip->duration <= resizingClip->startFrame) continue;
                     int clipStart = clip->startFrame;
 
@@ -786,9 +779,9 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
             bool videoClipSelected = false;
             bool audioClipSelected = false;
             
-            for (auto [clipID, selectedClip] : state.getSelectedClips()) {
+            for (auto selectedClip : state.getSelectedClips()) {
                 if (trackCollision) break;
-                int trackIdx = state.video->getClipMap()[clipID];
+                int trackIdx = state.video->getClipTrack(selectedClip->handle);
 
                 TrackType clipType = TrackType::Video;
                 int targetTrack = std::clamp(trackIdx + deltaTrack, 0, static_cast<int>(state.video->videoTracks.size()) - 1);
@@ -809,7 +802,7 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
                 }
 
                 if (isMovingBetweenTracks && targetTrack != selectedTrackIdx && selectedClip) {
-                    trackCollision = willClipCollide(selectedClip->startFrame, selectedClip->duration, targetTrack, clipType, { selectedClip->uID });
+                    trackCollision = willClipCollide(selectedClip->startFrame, selectedClip->duration, targetTrack, clipType, { selectedClip->handle });
                 }
             }
 
@@ -867,8 +860,8 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
                     : true
                 ))
             ) {
-                for (auto [clipID, selectedClip] : state.getSelectedClips()) {
-                    int trackIdx = state.video->getClipMap()[clipID];
+                for (auto selectedClip : state.getSelectedClips()) {
+                    int trackIdx = state.video->getClipTrack(selectedClip->handle);
 
                     TrackType clipType = TrackType::Video;
                     int targetTrack = trackIdx + (isOnSameTracks ? deltaTrack : (selectedTrackType == TrackType::Video ? deltaTrack : -deltaTrack));
@@ -879,31 +872,23 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
                     targetTrack = std::max(targetTrack, 0);
                     fmt::println("t: {}, d: {}", targetTrack, deltaTrack);
                     if (targetTrack < 0) continue;
-                    if (clipType == TrackType::Audio) {
-                        state.video->removeAudioClip(trackIdx, std::static_pointer_cast<AudioClip>(selectedClip));
-                        state.video->addAudioClip(targetTrack, std::static_pointer_cast<AudioClip>(selectedClip));
-                    } else {
-                        state.video->removeClip(trackIdx, selectedClip);
-                        state.video->addClip(targetTrack, selectedClip);
-                    }
+                    state.video->changeClipTrack(selectedClip, targetTrack);
                     if (trackIdx < 0) trackIdx = -(trackIdx + 1);
                     if (trackIdx == selectedTrackIdx && clipType == selectedTrackType) {
                         selectedTrackIdx = std::clamp(targetTrack, 0, trackQuantity - 1);
                     }
-                    // make sure the clip is still selected
-                    state.selectClip(selectedClip);
                 }
                 if (deltaTrack != 0) {
-                    state.addAction(std::make_shared<ChangeClipTrack>(state.selectedClips, deltaTrack, selectedTrackType, isOnSameTracks));
+                    state.addAction(std::make_shared<ChangeClipTrack>(state.getSelectedClips(), deltaTrack, selectedTrackType, isOnSameTracks));
                 }
             }
 
             // check if it collides with another clip
             bool clipCollision = false;
-            for (auto [clipID, selectedClip] : state.getSelectedClips()) {
+            for (auto selectedClip : state.getSelectedClips()) {
                 if (clipCollision) break;
                 TrackType clipType = TrackType::Video;
-                int trackIdx = state.video->getClipMap()[clipID];
+                int trackIdx = state.video->getClipTrack(selectedClip->handle);
                 int targetTrack = trackIdx;
                 if (trackIdx < 0) {
                     targetTrack = -(trackIdx + 1);
@@ -913,11 +898,11 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
                 int newStartFrame = selectedClip->startFrame + deltaFrame;
                 int newEndFrame = selectedClip->duration + newStartFrame;
 
-                clipCollision = willClipCollide(newStartFrame, selectedClip->duration, targetTrack, clipType, { selectedClip->uID });
+                clipCollision = willClipCollide(newStartFrame, selectedClip->duration, targetTrack, clipType, { selectedClip->handle });
             }
 
             if (!clipCollision) {
-                for (auto [trackIdx, selectedClip] : state.getSelectedClips()) {
+                for (auto selectedClip : state.getSelectedClips()) {
                     int newStartFrame = selectedClip->startFrame + deltaFrame;
                     selectedClip->startFrame = std::max(newStartFrame, 0);
                 }
@@ -935,7 +920,7 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
 
         if (selectedTrackType == TrackType::Video) {
             auto clips = state.video->videoTracks[selectedTrackIdx]->getClips();
-            for (auto [_, clip] : clips) {
+            for (auto& clip : clips) {
                 if (std::abs(state.currentFrame - clip->startFrame) <= snapThreshold) {
                     state.currentFrame = clip->startFrame;
                 }
@@ -946,7 +931,7 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
             }
         } else if (selectedTrackType == TrackType::Audio) {
             auto clips = state.video->audioTracks[selectedTrackIdx]->getClips();
-            for (auto [_, clip] : clips) {
+            for (auto& clip : clips) {
                 if (std::abs(state.currentFrame - clip->startFrame) <= snapThreshold) {
                     state.currentFrame = clip->startFrame;
                 }
@@ -959,9 +944,9 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
     }
 
     if (state.areClipsSelected()) {
-        for (auto [clipID, clip] : state.getSelectedClips()) {
+        for (auto clip : state.getSelectedClips()) {
             TrackType clipType = TrackType::Video;
-            int trackIdx = state.video->getClipMap()[clipID];
+            int trackIdx = state.video->getClipTrack(clip->handle);
             int targetTrack = trackIdx;
             if (trackIdx < 0) {
                 targetTrack = -(trackIdx + 1);
@@ -987,12 +972,12 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
                         }
 
                         if (clipType == TrackType::Video) {
-                            for (auto [_, _clip] : state.video->videoTracks[targetTrack]->getClips()) {
+                            for (auto& _clip : state.video->videoTracks[targetTrack]->getClips()) {
                                 if (clip == _clip) continue;
                                 doTheThingL(_clip);
                             }
                         } else {
-                            for (auto [_, _clip] : state.video->audioTracks[targetTrack]->getClips()) {
+                            for (auto& _clip : state.video->audioTracks[targetTrack]->getClips()) {
                                 if (clip == _clip) continue;
                                 doTheThingL(_clip);
                             }
@@ -1004,12 +989,12 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
                         }
 
                         if (clipType == TrackType::Video) {
-                            for (auto [_, _clip] : state.video->videoTracks[targetTrack]->getClips()) {
+                            for (auto& _clip : state.video->videoTracks[targetTrack]->getClips()) {
                                 if (clip == _clip) continue;
                                 doTheThingR(_clip);
                             }
                         } else {
-                            for (auto [_, _clip] : state.video->audioTracks[targetTrack]->getClips()) {
+                            for (auto& _clip : state.video->audioTracks[targetTrack]->getClips()) {
                                 if (clip == _clip) continue;
                                 doTheThingR(_clip);
                             }
@@ -1042,12 +1027,12 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
                 };
 
                 if (clipType == TrackType::Video) {
-                    for (auto [_, _clip] : state.video->videoTracks[targetTrack]->getClips()) {
+                    for (auto& _clip : state.video->videoTracks[targetTrack]->getClips()) {
                         if (clip == _clip) continue;
                         doTheThingDrag(_clip);
                     }
                 } else {
-                    for (auto [_, _clip] : state.video->audioTracks[targetTrack]->getClips()) {
+                    for (auto& _clip : state.video->audioTracks[targetTrack]->getClips()) {
                         if (clip == _clip) continue;
                         doTheThingDrag(_clip);
                     }
@@ -1056,12 +1041,19 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
         }
     }
 
+    // the drags and resizes above change timings in place, refile the clips they touched
+    if (resizeMode != RESIZE_NONE && resizingClip) {
+        state.video->updateClip(resizingClip);
+    }
+    for (auto clip : state.getSelectedClips()) {
+        state.video->updateClip(clip);
+    }
     state.video->recalculateFrameCount();
 
     if (ImGui::IsMouseReleased(0)) {
         if (isDragging && !isAdjustingFade) {
             if (resizeMode == RESIZE_NONE && totalDeltaFrame != 0) {
-                state.addAction(std::make_shared<MoveClip>(state.selectedClips, totalDeltaFrame));
+                state.addAction(std::make_shared<MoveClip>(state.getSelectedClips(), totalDeltaFrame));
             }
         }
         if (resizeMode != RESIZE_NONE) {
@@ -1070,7 +1062,7 @@ void Timeline::handleInteractions(const ImVec2& canvasPos, const ImVec2& canvasS
         totalDeltaFrame = 0;
         isDragging = false;
         isAdjustingFade = false;
-        fadeAdjustID = "";
+        fadeAdjustClip = {};
         isScrubbing = false;
         isMovingBetweenTracks = false;
         resizingClip = nullptr;
@@ -254,217 +254,4 @@ namespace utils::video {
             avformat_free_context(out_fmt_ctx);
         }
     }
-
-    void combineAV(std::string audio, std::string video, std::string disco) {
-        AVFormatContext *in_v_fmt = nullptr, *in_a_fmt = nullptr, *out_fmt = nullptr;
-        AVCodecContext *dec_ctx = nullptr, *enc_ctx = nullptr;
-        AVStream *in_v_stream = nullptr, *in_a_stream = nullptr;
-        AVStream *out_v_stream = nullptr, *out_a_stream = nullptr;
-        SwrContext *swr = nullptr;
-        int ret = 0;
-
-        auto fferr = [](int err) {
-            char buf[256];
-            av_strerror(err, buf, sizeof(buf));
-            return std::string(buf);
-        };
-
-        if ((ret = avformat_open_input(&in_v_fmt, video.c_str(), nullptr, nullptr)) < 0) {
-            fmt::println("open video input: {}", fferr(ret)); return;
-        }
-        if ((ret = avformat_find_stream_info(in_v_fmt, nullptr)) < 0) {
-            fmt::println("find video stream info: {}", fferr(ret)); return;
-        }
-
-        if ((ret = avformat_open_input(&in_a_fmt, audio.c_str(), nullptr, nullptr)) < 0) {
-            fmt::println("open audio input: {}", fferr(ret)); return;
-        }
-        if ((ret = avformat_find_stream_info(in_a_fmt, nullptr)) < 0) {
-            fmt::println("find audio stream info: {}", fferr(ret)); return;
-        }
-
-        ret = av_find_best_stream(in_v_fmt, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
-        if (ret < 0) { fmt::println("no video stream: {}", fferr(ret)); return; }
-        in_v_stream = in_v_fmt->streams[ret];
-
-        ret = av_find_best_stream(in_a_fmt, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
-        if (ret < 0) { fmt::println("no audio stream: {}", fferr(ret)); return; }
-        in_a_stream = in_a_fmt->streams[ret];
-
-        const AVCodec *dec = avcodec_find_decoder(in_a_stream->codecpar->codec_id);
-        if (!dec) { fmt::println("No audio decoder"); return; }
-        dec_ctx = avcodec_alloc_context3(dec);
-        avcodec_parameters_to_context(dec_ctx, in_a_stream->codecpar);
-        if ((ret = avcodec_open2(dec_ctx, dec, nullptr)) < 0) {
-            fmt::println("open audio decoder: {}", fferr(ret)); return;
-        }
-
-        const AVCodec *enc = avcodec_find_encoder(AV_CODEC_ID_AAC);
-        if (!enc) { fmt::println("No AAC encoder"); return; }
-        enc_ctx = avcodec_alloc_context3(enc);
-        enc_ctx->sample_rate = dec_ctx->sample_rate;
-        enc_ctx->ch_layout = dec_ctx->ch_layout;
-        av_channel_layout_default(&enc_ctx->ch_layout, dec_ctx->ch_layout.nb_channels);
-        enc_ctx->sample_fmt = enc->sample_fmts ? enc->sample_fmts[0] : AV_SAMPLE_FMT_FLTP;
-        enc_ctx->bit_rate = 128000;
-        enc_ctx->time_base = AVRational{1, enc_ctx->sample_rate};
-
-        if ((ret = avcodec_open2(enc_ctx, enc, nullptr)) < 0) {
-            fmt::println("open AAC encoder: {}", fferr(ret)); return;
-        }
-
-        swr = swr_alloc();
-        av_opt_set_chlayout(swr, "in_chlayout",  &dec_ctx->ch_layout, 0);
-        av_opt_set_int(swr, "in_sample_rate",   dec_ctx->sample_rate, 0);
-        av_opt_set_sample_fmt(swr, "in_sample_fmt", (AVSampleFormat)dec_ctx->sample_fmt, 0);
-        av_opt_set_chlayout(swr, "out_chlayout", &enc_ctx->ch_layout, 0);
-        av_opt_set_int(swr, "out_sample_rate",  enc_ctx->sample_rate, 0);
-        av_opt_set_sample_fmt(swr, "out_sample_fmt", enc_ctx->sample_fmt, 0);
-        if ((ret = swr_init(swr)) < 0) {
-            fmt::println("swr_init: {}", fferr(ret)); return;
-        }
-
-        AVDictionary *opts = nullptr;
-        av_dict_set(&opts, "max_muxing_queue_size", "9999", 0);
-
-        if ((ret = avformat_alloc_output_context2(&out_fmt, nullptr, nullptr, disco.c_str())) < 0) {
-            fmt::println("alloc output context: {}", fferr(ret)); return;
-        }
-
-        out_v_stream = avformat_new_stream(out_fmt, nullptr);
-        avcodec_parameters_copy(out_v_stream->codecpar, in_v_stream->codecpar);
-        out_v_stream->time_base = in_v_stream->time_base;
-
-        out_a_stream = avformat_new_stream(out_fmt, nullptr);
-        avcodec_parameters_from_context(out_a_stream->codecpar, enc_ctx);
-        out_a_stream->time_base = enc_ctx->time_base;
-
-        if (!(out_fmt->oformat->flags & AVFMT_NOFILE)) {
-            if ((ret = avio_open(&out_fmt->pb, disco.c_str(), AVIO_FLAG_WRITE)) < 0) {
-                fmt::println("avio_open: {}", fferr(ret)); return;
-            }
-        }
-
-        if ((ret = avformat_write_header(out_fmt, &opts)) < 0) {
-            fmt::println("write header: {}", fferr(ret));
-            av_dict_free(&opts);
-            return;
-        }
-        av_dict_free(&opts);
-
-        AVFrame *in_frame = av_frame_alloc();
-        AVFrame *out_frame = av_frame_alloc();
-        AVPacket pkt;
-
-        while (av_read_frame(in_v_fmt, &pkt) >= 0) {
-            if (pkt.stream_index == in_v_stream->index) {
-                av_packet_rescale_ts(&pkt, in_v_stream->time_base, out_v_stream->time_base);
-                pkt.stream_index = out_v_stream->index;
-                av_interleaved_write_frame(out_fmt, &pkt);
-                av_packet_unref(&pkt);
-            }
-        }
-
-        while (av_read_frame(in_a_fmt, &pkt) >= 0) {
-            if (pkt.stream_index != in_a_stream->index) {
-                av_packet_unref(&pkt);
-                continue;
-            }
-
-            ret = avcodec_send_packet(dec_ctx, &pkt);
-            av_packet_unref(&pkt);
-            if (ret < 0) break;
-
-            while ((ret = avcodec_receive_frame(dec_ctx, in_frame)) >= 0) {
-                out_frame->nb_samples = in_frame->nb_samples;
-                out_frame->format = enc_ctx->sample_fmt;
-                out_frame->sample_rate = enc_ctx->sample_rate;
-                av_channel_layout_copy(&out_frame->ch_layout, &enc_ctx->ch_layout);
-
-                if ((ret = av_frame_get_buffer(out_frame, 0)) < 0) {
-                    fmt::println("av_frame_get_buffer {}", ret);
-                    goto cleanup;
-                }
-
-                int converted_samples = swr_convert(
-                    swr,
-                    out_frame->data, out_frame->nb_samples,
-                    (const uint8_t **)in_frame->data, in_frame->nb_samples
-                );
-                if (converted_samples < 0) { fmt::println("swr_convert: {}", converted_samples); goto cleanup; }
-
-                int frame_size = enc_ctx->frame_size;
-                int offset = 0;
-                while (converted_samples - offset >= frame_size) {
-                    AVFrame *chunk = av_frame_alloc();
-                    chunk->nb_samples = frame_size;
-                    chunk->format = enc_ctx->sample_fmt;
-                    chunk->sample_rate = enc_ctx->sample_rate;
-                    av_channel_layout_copy(&chunk->ch_layout, &enc_ctx->ch_layout);
-
-                    if ((ret = av_frame_get_buffer(chunk, 0)) < 0) {
-                        fmt::println("av_frame_get_buffer {}", ret);
-                        av_frame_free(&chunk);
-                        break;
-                    }
-
-                    for (int ch = 0; ch < enc_ctx->ch_layout.nb_channels; ch++) {
-                        memcpy(chunk->data[ch],
-                            out_frame->data[ch] + offset * av_get_bytes_per_sample((AVSampleFormat)chunk->format),
-                            frame_size * av_get_bytes_per_sample((AVSampleFormat)chunk->format));
-                    }
-
-                    chunk->pts = av_rescale_q(in_frame->pts + offset,
-                                            in_a_stream->time_base,
-                                            enc_ctx->time_base);
-
-                    ret = avcodec_send_frame(enc_ctx, chunk);
-                    if (ret < 0) {
-                        fmt::println("send frame: {}", ret);
-                        av_frame_free(&chunk);
-                        break;
-                    }
-
-                    AVPacket out_pkt;
-                    av_init_packet(&out_pkt);
-                    out_pkt.data = nullptr;
-                    out_pkt.size = 0;
-
-                    while ((ret = avcodec_receive_packet(enc_ctx, &out_pkt)) >= 0) {
-                        av_packet_rescale_ts(&out_pkt, enc_ctx->time_base, out_a_stream->time_base);
-                        out_pkt.stream_index = out_a_stream->index;
-                        av_interleaved_write_frame(out_fmt, &out_pkt);
-                        av_packet_unref(&out_pkt);
-                    }
-
-                    av_frame_free(&chunk);
-                    offset += frame_size;
-                }
-
-                av_frame_unref(out_frame);
-                av_frame_unref(in_frame);
-            }
-        }
-
-        avcodec_send_frame(enc_ctx, nullptr);
-        while ((ret = avcodec_receive_packet(enc_ctx, &pkt)) >= 0) {
-            av_packet_rescale_ts(&pkt, enc_ctx->time_base, out_a_stream->time_base);
-            pkt.stream_index = out_a_stream->index;
-            av_interleaved_write_frame(out_fmt, &pkt);
-            av_packet_unref(&pkt);
-        }
-
-        av_write_trailer(out_fmt);
-
-    cleanup:
-        av_frame_free(&in_frame);
-        av_frame_free(&out_frame);
-        swr_free(&swr);
-        avcodec_free_context(&dec_ctx);
-        avcodec_free_context(&enc_ctx);
-        avformat_close_input(&in_v_fmt);
-        avformat_close_input(&in_a_fmt);
-        if (!(out_fmt->oformat->flags & AVFMT_NOFILE)) avio_closep(&out_fmt->pb);
-        avformat_free_context(out_fmt);
-    }
 }
@@ -1,25 +1,47 @@
 #include <video.hpp>
 
 #include <state.hpp>
+#include <renderer/pool.hpp>
+#include <renderer/prefetch.hpp>
+
+#include <fstream>
+
+void Video::registerClip(std::shared_ptr<Clip> clip, int track) {
+    if (auto slot = clipSlots.get(clip->handle); slot && slot->clip == clip) {
+        slot->track = track;
+        return;
+    }
+
+    clip->handle = clipSlots.insert({ clip, track });
+    handlesByID[clip->uID] = clip->handle;
+}
+
+void Video::unregisterClip(std::shared_ptr<Clip> clip) {
+    if (auto slot = clipSlots.get(clip->handle); !slot || slot->clip != clip) return;
+
+    clipSlots.remove(clip->handle);
+    handlesByID.erase(clip->uID);
+    clip->handle = {};
+}
 
 void Video::addClip(int trackIdx, std::shared_ptr<Clip> clip) {
     trackIdx = std::clamp(trackIdx, 0, static_cast<int>(videoTracks.size()) - 1);
     fmt::println("{}", trackIdx);
     videoTracks.at(trackIdx)->addClip(clip);
-    clipMap[clip->uID] = trackIdx;
+    registerClip(clip, trackIdx);
     recalculateFrameCount();
 }
 
 void Video::addAudioClip(int trackIdx, std::shared_ptr<AudioClip> clip) {
     trackIdx = std::clamp(trackIdx, 0, static_cast<int>(audioTracks.size()) - 1);
     audioTracks[trackIdx]->addClip(clip);
-    clipMap[clip->uID] = -(trackIdx + 1);
+    registerClip(clip, -(trackIdx + 1));
     recalculateFrameCount();
 }
 
 void Video::removeClip(int trackIdx, std::shared_ptr<Clip> clip) {
-    videoTracks.at(trackIdx)->removeClip(clip->uID);
-    clipMap.erase(clip->uID);
+    videoTracks.at(trackIdx)->removeClip(clip);
+    unregisterClip(clip);
     recalculateFrameCount();
 }
 
@@ -29,59 +51,123 @@ void Video::removeAudioClip(int trackIdx, std::shared_ptr<AudioClip> clip) {
         fmt::println("invalid point");
         return;
     }
-    audioTracks.at(trackIdx)->removeClip(clip->uID);
-    clipMap.erase(clip->uID);
+    audioTracks.at(trackIdx)->removeClip(clip);
+    unregisterClip(clip);
+    recalculateFrameCount();
+}
+
+void Video::changeClipTrack(std::shared_ptr<Clip> clip, int targetTrack) {
+    auto slot = clipSlots.get(clip->handle);
+    if (!slot) return;
+
+    if (slot->track < 0) {
+        auto audioClip = std::static_pointer_cast<AudioClip>(clip);
+        targetTrack = std::clamp(targetTrack, 0, static_cast<int>(audioTracks.size()) - 1);
+        audioTracks.at(-(slot->track + 1))->removeClip(audioClip);
+        audioTracks[targetTrack]->addClip(audioClip);
+        slot->track = -(targetTrack + 1);
+    } else {
+        targetTrack = std::clamp(targetTrack, 0, static_cast<int>(videoTracks.size()) - 1);
+        videoTracks.at(slot->track)->removeClip(clip);
+        videoTracks[targetTrack]->addClip(clip);
+        slot->track = targetTrack;
+    }
     recalculateFrameCount();
 }
 
-Frame* Video::renderAtFrame(int frameNum) {
-    auto frame = std::make_shared<Frame>(resolution.x, resolution.y);
+std::shared_ptr<Clip> Video::getClip(ClipHandle handle) const {
+    auto slot = clipSlots.get(handle);
+    return slot ? slot->clip : nullptr;
+}
+
+int Video::getClipTrack(ClipHandle handle) const {
+    auto slot = clipSlots.get(handle);
+    return slot ? slot->track : 0;
+}
+
+ClipHandle Video::findClip(const std::string& uID) const {
+    auto it = handlesByID.find(uID);
+    return it != handlesByID.end() ? it->second : ClipHandle {};
+}
+
+std::shared_ptr<Frame> Video::renderAtFrame(int frameNum) {
+    auto frame = FramePool::get().acquire(resolution.x, resolution.y);
+    frame->clearFrame();
     renderIntoFrame(frameNum, frame);
-    return frame.get();
+    return frame;
 }
 
 void Video::renderIntoFrame(int frameNum, std::shared_ptr<Frame> frame) {
+    // tracks that didn't change since the last call hand back the same layer without drawing
     for (auto track : videoTracks) {
-        track->render(frame.get(), frameNum);
+        if (auto layer = track->renderLayer(frameNum, frame.get())) {
+            frame->drawLayer(layer);
+        }
     }
+    frame->flush();
 }
 
 void Video::render(VideoRenderer* renderer) {
     recalculateFrameCount();
-    auto frame = std::make_shared<Frame>(resolution.x, resolution.y);
+    auto frame = FramePool::get().acquire(resolution.x, resolution.y);
     auto& state = State::get();
+    state.isExporting = true;
+    // keyframes for the frames ahead are worked out on other threads while these render
+    PropertyPrefetch prefetch(*this);
     for (int currentFrame = 0; currentFrame < frameCount; currentFrame++) {
         state.currentFrame = currentFrame;
+        prefetch.advance(currentFrame);
         frame->clearFrame();
         renderIntoFrame(currentFrame, frame);
         renderer->addFrame(frame);
     }
+    state.isExporting = false;
+}
+
+void Video::updateClip(std::shared_ptr<Clip> clip) {
+    auto slot = clipSlots.get(clip->handle);
+    if (!slot) return;
+
+    int trackIdx = slot->track;
+    if (trackIdx < 0) {
+        audioTracks.at(-(trackIdx + 1))->updateClip(std::static_pointer_cast<AudioClip>(clip));
+    } else {
+        videoTracks.at(trackIdx)->updateClip(clip);
+    }
+    recalculateFrameCount();
 }
 
 void Video::recalculateFrameCount() {
     int currentFrameCount = 0;
-    for (auto track : videoTracks) {
-        auto clips = track->getClips();
-        for (auto _clip : clips) {
-            auto clip = _clip.second;
-            currentFrameCount = std::max(clip->startFrame + clip->duration, currentFrameCount);
-        }
+    for (auto& track : videoTracks) {
+        currentFrameCount = std::max(track->getEndFrame(), currentFrameCount);
     }
 
     // if it's still 0, then check audio
     if (currentFrameCount == 0) {
-        for (auto track : audioTracks) {
-            auto clips = track->getClips();
-            for (auto _clip : clips) {
-                auto clip = _clip.second;
-                currentFrameCount = std::max(clip->startFrame + clip->duration, currentFrameCount);
-            }
+        for (auto& track : audioTracks) {
+            currentFrameCount = std::max(track->getEndFrame(), currentFrameCount);
         }
     }
 
     frameCount = currentFrameCount;
 }
 
+std::shared_ptr<Video> Video::fromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        fmt::println("could not open project {}", path);
+        return nullptr;
+    }
+
+    std::vector<unsigned char> fileBuffer(std::istreambuf_iterator<char>(file), {});
+    qn::ByteReader reader(fileBuffer);
+    auto video = std::make_shared<Video>();
+    video->read(reader);
+    video->recalculateFrameCount();
+    return video;
+}
+
 int Video::frameForTime(float time) {
     return std::floor(time * (float)getFPS());
 }